@@ -0,0 +1,47 @@
+# 将SPIR-V文件转换为C++头文件中的constexpr数组
+# 用法: cmake -DOUTPUT=<头文件> -DSPIRV_FILES=<a.spv|b.spv|...> -P EmbedSpirv.cmake
+# 列表用'|'分隔，避免分号在命令行中被拆分
+
+if(NOT OUTPUT OR NOT SPIRV_FILES)
+    message(FATAL_ERROR "EmbedSpirv.cmake: OUTPUT and SPIRV_FILES are required")
+endif()
+
+string(REPLACE "|" ";" SPIRV_FILES "${SPIRV_FILES}")
+
+set(CONTENT "// Generated by cmake/EmbedSpirv.cmake, do not edit\n")
+string(APPEND CONTENT "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n\nnamespace EmbeddedShaders {\n\n")
+set(ENTRIES "")
+
+foreach(SPIRV_FILE ${SPIRV_FILES})
+    get_filename_component(SPIRV_NAME ${SPIRV_FILE} NAME)
+    string(MAKE_C_IDENTIFIER ${SPIRV_NAME} SPIRV_IDENTIFIER)
+
+    file(READ ${SPIRV_FILE} SPIRV_HEX HEX)
+    string(LENGTH "${SPIRV_HEX}" SPIRV_HEX_LENGTH)
+    math(EXPR SPIRV_REMAINDER "${SPIRV_HEX_LENGTH} % 8")
+    if(SPIRV_HEX_LENGTH EQUAL 0 OR NOT SPIRV_REMAINDER EQUAL 0)
+        message(FATAL_ERROR "Invalid SPIR-V file: ${SPIRV_FILE}")
+    endif()
+
+    # SPIR-V是小端的32位字，每8个字一行
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1u, " SPIRV_WORDS "${SPIRV_HEX}")
+    string(REPEAT "0x[0-9a-f]+u, " 8 SPIRV_LINE_PATTERN)
+    string(REGEX REPLACE "(${SPIRV_LINE_PATTERN})" "\\1\n    " SPIRV_WORDS "${SPIRV_WORDS}")
+    string(REPLACE " \n" "\n" SPIRV_WORDS "${SPIRV_WORDS}")
+    string(STRIP "${SPIRV_WORDS}" SPIRV_WORDS)
+
+    string(APPEND CONTENT "constexpr uint32_t ${SPIRV_IDENTIFIER}[] = {\n    ${SPIRV_WORDS}\n};\n\n")
+    string(APPEND ENTRIES "    { \"${SPIRV_NAME}\", ${SPIRV_IDENTIFIER}, sizeof(${SPIRV_IDENTIFIER}) / sizeof(uint32_t) },\n")
+endforeach()
+
+string(APPEND CONTENT "struct Entry {\n    const char* name;\n    const uint32_t* code;\n    size_t wordCount;\n};\n\n")
+string(APPEND CONTENT "constexpr Entry entries[] = {\n${ENTRIES}};\n\n} // namespace EmbeddedShaders\n")
+
+# 内容不变时不重写，避免触发重新编译
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} OLD_CONTENT)
+    if(OLD_CONTENT STREQUAL CONTENT)
+        return()
+    endif()
+endif()
+file(WRITE ${OUTPUT} "${CONTENT}")
@@ -77,6 +77,32 @@ void Camera::setView(const std::string& view) {
     m_zoom = 1.0f / m_distance;
 }
 
+void Camera::fitBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    float radius = glm::max(glm::length(boundsMax - boundsMin) * 0.5f, 1e-3f);
+
+    // Keep the whole box in front of the camera
+    m_centerPoint = center;
+    m_distance = radius + 1.0f;
+    glm::vec3 forward = m_orientation * glm::vec3(0.0f, 0.0f, 1.0f);
+    m_position = m_centerPoint + forward * m_distance;
+
+    // Orthographic half-height is 100 * m_zoom, leave a small margin and
+    // account for portrait viewports where the width is the limit
+    float aspectRatio = static_cast<float>(m_width) / static_cast<float>(m_height);
+    m_zoom = radius * 1.05f / (100.0f * glm::min(aspectRatio, 1.0f));
+}
+
+void Camera::setViewportSize(int width, int height) {
+    // A minimized window reports a zero size, keep the last valid aspect ratio
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    recalculateMatrices();
+}
+
 void Camera::recalculateMatrices() {
     // Simple orthographic projection
     float aspectRatio = static_cast<float>(m_width) / static_cast<float>(m_height);
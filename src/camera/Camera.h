@@ -19,6 +19,10 @@ public:
     void setCenterPoint(const glm::vec3& center);
     void moveCenterPoint(const glm::vec3& offset);
     void setView(const std::string& view);
+    // Center on a bounding box and zoom so that it fits the viewport
+    void fitBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+    // Viewport size in pixels; changes the aspect ratio of the projection
+    void setViewportSize(int width, int height);
 
     // Get matrices
     const glm::mat4& getViewMatrix() const { return m_viewMatrix; }
@@ -31,6 +35,8 @@ public:
     float getZoom() const { return m_zoom; }
     const glm::vec3& getPosition() const { return m_position; }
     const glm::vec3& getCenterPoint() const { return m_centerPoint; }
+    int getViewportWidth() const { return m_width; }
+    int getViewportHeight() const { return m_height; }
 
 private:
     void recalculateMatrices();
@@ -1,6 +1,7 @@
 #include "Application.h"
 #include "VulkanContext.h"
 #include "Renderer.h"
+#include "PointCloudRenderer.h"
 #include "InputHandler.h"
 #include "UI.h"
 #include "Camera.h"
@@ -9,14 +10,22 @@
 #include "PluginManager.h"
 #include "PluginContext.h"
 #include "DemoPlugin.h"
+#include "ImageWriter.h"
+#include "BatchRenderer.h"
+#include "FrameLimiter.h"
 #include <thread>
+#include <algorithm>
 
 Application::Application(const std::string& title, int width, int height)
-    : m_title(title), m_width(width), m_height(height), m_running(false),
+    : m_title(title), m_width(width), m_height(height), m_running(false), m_headless(false),
       m_vulkanContext(nullptr), m_renderer(nullptr), m_inputHandler(nullptr),
       m_ui(nullptr), m_camera(nullptr),
       m_pluginContext(nullptr), m_pluginManager(std::make_unique<PluginManager>()) {}
 
+void Application::setBatchOptions(const BatchOptions& options) {
+    m_batchOptions = std::make_unique<BatchOptions>(options);
+}
+
 Application::~Application() {
     shutdown();
 }
@@ -25,20 +34,37 @@ bool Application::init() {
     try {
         // 配置系统已经在run()方法中初始化
         Config& config = Config::getInstance();
+
+        // 无窗口模式：渲染到离屏图像，没有输入和UI
+        m_headless = config.getBool("headless", false);
+        if (m_batchOptions) {
+            // 批量模式总是无窗口，尺寸来自命令行
+            m_headless = true;
+            m_width = m_batchOptions->width;
+            m_height = m_batchOptions->height;
+        } else if (m_headless) {
+            m_width = config.getInt("headless_width", m_width);
+            m_height = config.getInt("headless_height", m_height);
+        }
         
         // 初始化Vulkan上下文
         m_vulkanContext = std::make_unique<VulkanContext>(m_width, m_height, m_title.c_str());
+        m_vulkanContext->setHeadless(m_headless);
         if (!m_vulkanContext->init()) {
             Logger::error("Failed to initialize Vulkan context!");
             return false;
         }
 
-        // 创建相机
-        m_camera = std::make_unique<Camera>(m_width, m_height);
+        // 创建相机（使用交换链的实际大小）
+        VkExtent2D extent = m_vulkanContext->getSwapchainExtent();
+        m_camera = std::make_unique<Camera>(static_cast<int>(extent.width), static_cast<int>(extent.height));
 
         // 初始化输入处理（先用nullptr，稍后设置UI）
-        m_inputHandler = std::make_unique<InputHandler>(m_vulkanContext->getWindow(), m_camera.get());
-        m_inputHandler->init();
+        if (!m_headless) {
+            m_inputHandler = std::make_unique<InputHandler>(m_vulkanContext->getWindow(), m_camera.get());
+            m_inputHandler->setVulkanContext(m_vulkanContext.get());
+            m_inputHandler->init();
+        }
 
         // 初始化渲染器，先不传递UI指针
         m_renderer = std::make_unique<Renderer>(m_vulkanContext.get(), m_camera.get(), nullptr);
@@ -48,20 +74,22 @@ bool Application::init() {
         }
         
         // 创建并初始化UI
-        m_ui = std::make_unique<UI>(m_vulkanContext.get(), m_renderer.get(), m_camera.get());
-        if (!m_ui->init()) {
-            Logger::error("Failed to initialize UI!");
-            return false;
-        }
+        if (!m_headless) {
+            m_ui = std::make_unique<UI>(m_vulkanContext.get(), m_renderer.get(), m_camera.get());
+            if (!m_ui->init()) {
+                Logger::error("Failed to initialize UI!");
+                return false;
+            }
 
-        // 设置渲染器的UI指针
-        m_renderer->setUI(m_ui.get());
+            // 设置渲染器的UI指针
+            m_renderer->setUI(m_ui.get());
 
-        // 设置UI的GridRenderer指针
-        m_ui->setGridRenderer(m_renderer->getGridRenderer());
-        
-        // 设置输入处理器的UI指针
-        m_inputHandler->setUI(m_ui.get());
+            // 设置UI的GridRenderer指针
+            m_ui->setGridRenderer(m_renderer->getGridRenderer());
+            
+            // 设置输入处理器的UI指针
+            m_inputHandler->setUI(m_ui.get());
+        }
         
         // 初始化插件系统
         m_pluginContext = std::make_unique<PluginContext>(
@@ -73,8 +101,13 @@ bool Application::init() {
         // 设置渲染器的PluginContext
         m_renderer->setPluginContext(m_pluginContext.get());
 
-        // 设置输入处理器的PluginContext用于点选择
-        m_inputHandler->setPluginContext(m_pluginContext.get());
+        if (!m_headless) {
+            // 设置输入处理器的PluginContext用于点选择
+            m_inputHandler->setPluginContext(m_pluginContext.get());
+
+            // 设置UI的PluginContext用于点云缓存操作
+            m_ui->setPluginContext(m_pluginContext.get());
+        }
 
         // 初始化插件管理器
         if (!m_pluginManager->init(m_pluginContext.get())) {
@@ -93,6 +126,12 @@ bool Application::init() {
             return false;
         }
         
+        // 加载上次使用的点云缓存（零拷贝映射，无需重新转换）
+        std::string pointCacheFile = m_batchOptions ? "" : config.getString("point_cache_file");
+        if (!pointCacheFile.empty() && !m_pluginContext->loadPointCache(pointCacheFile)) {
+            Logger::warn("Configured point cache could not be loaded: {}", pointCacheFile);
+        }
+        
         if (config.isDebugMode()) {
             Logger::info("=== Camera Controls ===");
             Logger::info("- Right Mouse + Drag: Rotate camera");
@@ -124,9 +163,16 @@ void Application::run() {
         return;
     }
     
-    Logger::debug("Application::init succeeded, entering mainLoop...");
-    
-    mainLoop();
+    if (m_batchOptions) {
+        Logger::debug("Application::init succeeded, rendering batch...");
+        renderBatch();
+    } else if (m_headless) {
+        Logger::debug("Application::init succeeded, rendering headless...");
+        renderHeadless();
+    } else {
+        Logger::debug("Application::init succeeded, entering mainLoop...");
+        mainLoop();
+    }
     
     Logger::debug("mainLoop exited, shutting down...");
     shutdown();
@@ -141,57 +187,130 @@ void Application::mainLoop() {
     
     int frameCount = 0;
     
-    // FPS控制相关变量
+    // FPS控制：FIFO模式已经由垂直同步限速，只有目标帧率低于刷新率时才需要额外限制
+    FrameLimiter frameLimiter;
+    frameLimiter.setSpinMargin(std::chrono::microseconds(config.getInt("frame_limiter_spin_us", 2000)));
+    int refreshRate = 0;
+    if (GLFWmonitor* monitor = glfwGetPrimaryMonitor()) {
+        if (const GLFWvidmode* mode = glfwGetVideoMode(monitor)) {
+            refreshRate = mode->refreshRate;
+        }
+    }
+    
+    // 按需渲染：没有输入、相机变化、数据变化或插件请求时不渲染，只等待事件
+    bool renderOnDemand = config.getBool("render_on_demand", false);
+    double idleTimeout = (std::max)(config.getInt("render_on_demand_timeout_ms", 250), 1) / 1000.0;
+    // ImGui在输入之后需要额外几帧来更新悬停和动画状态
+    const int framesAfterInput = 3;
+    int pendingFrames = framesAfterInput;
+    glm::mat4 lastViewProjection = m_camera->getViewProjectionMatrix();
+    
     using namespace std::chrono;
     steady_clock::time_point lastFrameTime = steady_clock::now();
     
     while (m_running && !m_vulkanContext->shouldClose()) {
-        // 记录当前帧开始时间
-        steady_clock::time_point currentFrameTime = steady_clock::now();
-        
-        // 计算上一帧耗时（毫秒）
-        duration<float, std::milli> frameDuration = currentFrameTime - lastFrameTime;
-        
-        // 计算deltaTime（秒）
-        float deltaTime = frameDuration.count() / 1000.0f;
-        
-        // 计算目标帧时间（毫秒）
         int targetFPS = config.getFPS();
-        float targetFrameTime = 1000.0f / targetFPS;
-        
-        Logger::trace("Frame {} - polling events...", frameCount++);
+        if (m_vulkanContext->getPresentMode() == VK_PRESENT_MODE_FIFO_KHR &&
+            refreshRate > 0 && targetFPS >= refreshRate) {
+            targetFPS = 0;
+        }
+        frameLimiter.setTargetFPS(targetFPS);
+
+        // 分页点云的可见节点尚未全部上传时继续渲染，直到加载完成
+        PointCloudRenderer* pointCloudRenderer = m_renderer->getPointCloudRenderer();
+        bool loadingPoints = pointCloudRenderer && pointCloudRenderer->needsMoreFrames();
+        bool idle = renderOnDemand && pendingFrames == 0 && !m_pluginContext->needsRedraw() && !loadingPoints;
+        if (idle) {
+            // 空闲时阻塞等待事件，超时后仍然更新插件
+            m_inputHandler->waitEvents(idleTimeout);
+        } else {
+            // 在采样输入之前等待，使输入到画面的延迟最小
+            frameLimiter.wait();
+            m_inputHandler->pollEvents();
+        }
         
-        m_inputHandler->pollEvents();
+        // 计算deltaTime（秒），包含上一帧的等待时间
+        steady_clock::time_point currentFrameTime = steady_clock::now();
+        duration<float> frameDuration = currentFrameTime - lastFrameTime;
+        float deltaTime = frameDuration.count();
+        lastFrameTime = currentFrameTime;
         
-        Logger::trace("Frame {} - updating camera...", frameCount);
+        Logger::trace("Frame {} - updating camera...", frameCount++);
         
         m_camera->update();
         
         // 更新插件
         m_pluginManager->update(deltaTime);
+
+        if (renderOnDemand) {
+            if (m_inputHandler->consumeEvents()) {
+                pendingFrames = framesAfterInput;
+            }
+            if (m_camera->getViewProjectionMatrix() != lastViewProjection ||
+                m_pluginContext->needsRedraw() || m_vulkanContext->isFramebufferResized() || loadingPoints) {
+                pendingFrames = (std::max)(pendingFrames, 1);
+            }
+            lastViewProjection = m_camera->getViewProjectionMatrix();
+            m_pluginContext->clearRedrawRequest();
+
+            if (pendingFrames == 0) {
+                continue;
+            }
+            pendingFrames--;
+        }
         
         Logger::trace("Frame {} - rendering and updating UI...", frameCount);
         
         m_renderer->render();
         
         Logger::trace("Frame {} - completed!", frameCount);
-        
-        // 更新上一帧时间
-        lastFrameTime = steady_clock::now();
-        
-        // 计算当前帧总耗时
-        duration<float, std::milli> totalFrameDuration = lastFrameTime - currentFrameTime;
-        
-        // 如果帧耗时小于目标帧时间，休眠剩余时间
-        if (totalFrameDuration.count() < targetFrameTime) {
-            float sleepTime = targetFrameTime - totalFrameDuration.count();
-            std::this_thread::sleep_for(milliseconds(static_cast<long long>(sleepTime)));
-        }
     }
     
     Logger::debug("Exiting mainLoop...");
 }
 
+void Application::renderHeadless() {
+    Config& config = Config::getInstance();
+
+    std::string view = config.getString("headless_view");
+    if (!view.empty()) {
+        m_camera->setView(view);
+    }
+
+    // 渲染若干帧，让插件有机会生成数据
+    int frameCount = (std::max)(config.getInt("headless_frames", 1), 1);
+    float deltaTime = 1.0f / (std::max)(config.getFPS(), 1);
+    for (int frame = 0; frame < frameCount; frame++) {
+        m_camera->update();
+        m_pluginManager->update(deltaTime);
+        m_renderer->render();
+    }
+
+    // 点云GPU绘制耗时（点列表与点精灵两种路径可分别运行对比）
+    PointCloudRenderer* pointCloudRenderer = m_renderer->getPointCloudRenderer();
+    if (pointCloudRenderer && pointCloudRenderer->getAverageGpuDrawTimeMs() > 0.0) {
+        Logger::info("Point draw GPU time: {:.3f} ms average ({})", pointCloudRenderer->getAverageGpuDrawTimeMs(),
+                     pointCloudRenderer->getDrawPathName());
+    }
+
+    // 回读最后一帧并保存
+    std::string output = config.getString("headless_output", "headless.ppm");
+    std::vector<uint8_t> pixels;
+    if (!m_vulkanContext->readbackImage(m_renderer->getLastImageIndex(), pixels)) {
+        Logger::error("Failed to read back headless frame!");
+        return;
+    }
+    VkExtent2D extent = m_vulkanContext->getSwapchainExtent();
+    if (ImageWriter::writePPM(output, extent.width, extent.height, pixels)) {
+        Logger::info("Headless frame written: {} ({}x{})", output, extent.width, extent.height);
+    }
+}
+
+bool Application::renderBatch() {
+    BatchRenderer batch(m_vulkanContext.get(), m_renderer.get(), m_camera.get(), m_pluginContext.get());
+    return batch.run(*m_batchOptions);
+}
+
 void Application::shutdown() {
     // 智能指针会自动释放内存，无需手动delete
     m_running = false;
@@ -12,6 +12,7 @@ class Camera;
 class Config;
 class PluginManager;
 class PluginContext;
+struct BatchOptions;
 
 class Application {
 public:
@@ -19,6 +20,8 @@ public:
     ~Application();
 
     void run();
+    // Render the datasets of a batch list instead of opening a window; call before run()
+    void setBatchOptions(const BatchOptions& options);
     void shutdown();
 
     int getWidth() const { return m_width; }
@@ -30,15 +33,19 @@ public:
     InputHandler* getInputHandler() const { return m_inputHandler.get(); }
     UI* getUI() const { return m_ui.get(); }
     Camera* getCamera() const { return m_camera.get(); }
+    PluginContext* getPluginContext() const { return m_pluginContext.get(); }
 
 private:
     bool init();
     void mainLoop();
+    void renderHeadless();
+    bool renderBatch();
 
     std::string m_title;
     int m_width;
     int m_height;
     bool m_running;
+    bool m_headless;
 
     std::unique_ptr<VulkanContext> m_vulkanContext;
     std::unique_ptr<Renderer> m_renderer;
@@ -48,4 +55,6 @@ private:
     
     std::unique_ptr<PluginContext> m_pluginContext;
     std::unique_ptr<PluginManager> m_pluginManager;
+
+    std::unique_ptr<BatchOptions> m_batchOptions;
 };
@@ -0,0 +1,163 @@
+#include "BatchRenderer.h"
+#include "VulkanContext.h"
+#include "Renderer.h"
+#include "FrameReadback.h"
+#include "PointCloudRenderer.h"
+#include "Camera.h"
+#include "PluginContext.h"
+#include "PointCache.h"
+#include "ImageWriter.h"
+#include "ThreadPool.h"
+#include "Logger.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+struct BatchJob {
+    std::string dataset;
+    std::string view;
+    std::string output;
+};
+
+std::string makeOutputName(const BatchOptions& options, const std::string& dataset, const std::string& view) {
+    size_t slash = dataset.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? dataset : dataset.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) {
+        name = name.substr(0, dot);
+    }
+    return options.outputDir + "/" + name + "_" + view + "." + options.format;
+}
+
+} // namespace
+
+bool BatchOptions::parse(int argc, char** argv, BatchOptions& options) {
+    bool batch = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--batch" && hasValue) {
+            options.listFile = argv[++i];
+            batch = true;
+        } else if (arg == "--view" && hasValue) {
+            options.view = argv[++i];
+        } else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0) {
+                Logger::error("Invalid --size, expected <width>x<height>: {}", argv[i]);
+                return false;
+            }
+        } else if (arg == "--output" && hasValue) {
+            options.outputDir = argv[++i];
+        } else if (arg == "--format" && hasValue) {
+            options.format = argv[++i];
+            if (options.format != "png" && options.format != "ppm") {
+                Logger::error("Invalid --format, expected png or ppm: {}", options.format);
+                return false;
+            }
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else {
+            Logger::error("Unknown or incomplete argument: {}", arg);
+            return false;
+        }
+    }
+    return batch;
+}
+
+BatchRenderer::BatchRenderer(VulkanContext* vulkanContext, Renderer* renderer, Camera* camera,
+                             PluginContext* pluginContext)
+    : m_vulkanContext(vulkanContext), m_renderer(renderer), m_camera(camera),
+      m_pluginContext(pluginContext) {
+}
+
+bool BatchRenderer::run(const BatchOptions& options) {
+    std::ifstream list(options.listFile);
+    if (!list.is_open()) {
+        Logger::error("Failed to open batch list: {}", options.listFile);
+        return false;
+    }
+
+    std::vector<BatchJob> jobs;
+    std::string line;
+    while (std::getline(list, line)) {
+        std::istringstream fields(line);
+        BatchJob job;
+        if (!(fields >> job.dataset) || job.dataset[0] == '#') {
+            continue;
+        }
+        if (!(fields >> job.view)) {
+            job.view = options.view;
+        }
+        job.output = makeOutputName(options, job.dataset, job.view);
+        jobs.push_back(job);
+    }
+    Logger::info("Batch rendering {} datasets from {}", jobs.size(), options.listFile);
+
+    FrameReadback readback(m_vulkanContext);
+    if (!readback.init()) {
+        return false;
+    }
+
+    // Encoding runs on worker threads while the next datasets render
+    ThreadPool encoders(static_cast<size_t>(options.threads > 0 ? options.threads : 0));
+    std::atomic<size_t> written(0);
+    readback.setCallback([&](uint64_t tag, const uint8_t* rgba, uint32_t width, uint32_t height) {
+        std::vector<uint8_t> pixels(rgba, rgba + static_cast<size_t>(width) * height * 4);
+        const std::string& output = jobs[tag].output;
+        encoders.submit([&written, output, width, height, pixels = std::move(pixels)]() {
+            if (ImageWriter::write(output, width, height, pixels)) {
+                written++;
+            }
+        });
+    });
+    m_renderer->setFrameReadback(&readback);
+
+    // Each dataset is read back from its first frame, so a paged pool uploads
+    // everything in view at once instead of filling in over several frames
+    PointCloudRenderer* pointCloudRenderer = m_renderer->getPointCloudRenderer();
+    uint32_t uploadBudget = 0;
+    if (pointCloudRenderer) {
+        uploadBudget = pointCloudRenderer->getUploadBudget();
+        pointCloudRenderer->setUploadBudget(UINT32_MAX);
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const BatchJob& job = jobs[i];
+        if (!m_pluginContext->loadPointCache(job.dataset)) {
+            Logger::warn("Skipping dataset that could not be loaded: {}", job.dataset);
+            continue;
+        }
+
+        const PointCacheHeader& header = m_pluginContext->getPointCache()->getHeader();
+        m_camera->setView(job.view);
+        m_camera->fitBounds(glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+                            glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]));
+        m_camera->update();
+
+        readback.request(i);
+        m_renderer->render();
+    }
+
+    readback.flush();
+    encoders.wait();
+    m_renderer->setFrameReadback(nullptr);
+    if (pointCloudRenderer) {
+        pointCloudRenderer->setUploadBudget(uploadBudget);
+    }
+    readback.cleanup();
+
+    std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - startTime;
+    float perHour = elapsed.count() > 0.0f ? written * 3600.0f / elapsed.count() : 0.0f;
+    Logger::info("Batch finished: {} of {} images written in {:.1f} s ({:.0f} per hour)",
+                 written.load(), jobs.size(), elapsed.count(), perHour);
+    return written == jobs.size();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+
+class VulkanContext;
+class Renderer;
+class Camera;
+class PluginContext;
+
+// Command line options of the batch thumbnail mode:
+//   demo --batch <list> [--view <name>] [--size <w>x<h>] [--output <dir>] [--format png|ppm]
+// Each non-empty line of <list> names a point cache file, optionally followed
+// by a camera preset (Camera::setView name) overriding --view for that file.
+struct BatchOptions {
+    std::string listFile;
+    std::string view = "Home";
+    int width = 256;
+    int height = 256;
+    std::string outputDir = ".";
+    std::string format = "png";
+    int threads = 0;            // encoder threads, 0 = hardware concurrency
+
+    // Returns false if argv does not request batch mode or is malformed
+    static bool parse(int argc, char** argv, BatchOptions& options);
+};
+
+// Renders every dataset of a batch list offscreen and writes one image per
+// dataset. Frames are read back through FrameReadback and encoded on worker
+// threads while the following datasets render.
+class BatchRenderer {
+public:
+    BatchRenderer(VulkanContext* vulkanContext, Renderer* renderer, Camera* camera,
+                  PluginContext* pluginContext);
+
+    bool run(const BatchOptions& options);
+
+private:
+    VulkanContext* m_vulkanContext;
+    Renderer* m_renderer;
+    Camera* m_camera;
+    PluginContext* m_pluginContext;
+};
@@ -0,0 +1,59 @@
+#include "FrameLimiter.h"
+#include <thread>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <timeapi.h>
+#endif
+
+FrameLimiter::FrameLimiter()
+    : m_targetFPS(0), m_framePeriod(Clock::duration::zero()),
+      m_nextFrameTime(Clock::now()), m_spinMargin(2000) {
+#ifdef _WIN32
+    // The default Windows timer resolution makes sleeps overshoot by up to ~15 ms
+    timeBeginPeriod(1);
+#endif
+}
+
+FrameLimiter::~FrameLimiter() {
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void FrameLimiter::setTargetFPS(int fps) {
+    if (fps == m_targetFPS) {
+        return;
+    }
+    m_targetFPS = fps > 0 ? fps : 0;
+    m_framePeriod = m_targetFPS > 0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_targetFPS))
+        : Clock::duration::zero();
+    m_nextFrameTime = Clock::now();
+}
+
+void FrameLimiter::wait() {
+    if (m_targetFPS <= 0) {
+        return;
+    }
+
+    m_nextFrameTime += m_framePeriod;
+    Clock::time_point now = Clock::now();
+
+    // Fell behind by more than a frame (stall, breakpoint, minimized window):
+    // restart the grid instead of rushing through the missed frames
+    if (now > m_nextFrameTime + m_framePeriod) {
+        m_nextFrameTime = now;
+        return;
+    }
+
+    if (m_nextFrameTime - now > m_spinMargin) {
+        std::this_thread::sleep_for(m_nextFrameTime - now - m_spinMargin);
+    }
+    while (Clock::now() < m_nextFrameTime) {
+        std::this_thread::yield();
+    }
+}
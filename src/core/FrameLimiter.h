@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+
+// Paces the main loop to a target frame rate. Frames are scheduled on a fixed
+// grid of absolute deadlines so that sleep overshoot does not accumulate; the
+// bulk of the wait uses the OS sleep and the last spinMargin is busy-waited
+// for sub-millisecond precision.
+class FrameLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FrameLimiter();
+    ~FrameLimiter();
+
+    // fps <= 0 disables limiting
+    void setTargetFPS(int fps);
+    int getTargetFPS() const { return m_targetFPS; }
+    void setSpinMargin(std::chrono::microseconds margin) { m_spinMargin = margin; }
+
+    // Block until the next frame should start
+    void wait();
+
+private:
+    int m_targetFPS;
+    Clock::duration m_framePeriod;
+    Clock::time_point m_nextFrameTime;
+    std::chrono::microseconds m_spinMargin;
+};
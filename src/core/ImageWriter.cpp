@@ -0,0 +1,177 @@
+#include "ImageWriter.h"
+#include "Logger.h"
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+struct Crc32Table {
+    uint32_t values[256];
+
+    Crc32Table() {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            values[n] = c;
+        }
+    }
+};
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    // Function-local static: initialized once, thread-safe for the encode workers
+    static const Crc32Table table;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.values[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void writeChunk(std::ofstream& file, const char type[4], const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    appendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    appendBigEndian(chunk, crc32(chunk.data() + 4, data.size() + 4));
+    file.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+}
+
+} // namespace
+
+bool ImageWriter::writePPM(const std::string& filename, uint32_t width, uint32_t height,
+                           const std::vector<uint8_t>& rgba) {
+    if (rgba.size() < static_cast<size_t>(width) * height * 4) {
+        Logger::error("Not enough pixel data for {}x{} image: {}", width, height, filename);
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        Logger::error("Failed to open image for writing: {}", filename);
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* src = rgba.data() + static_cast<size_t>(y) * width * 4;
+        for (uint32_t x = 0; x < width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+    }
+
+    file.close();
+    if (!file) {
+        Logger::error("Failed to write image: {}", filename);
+        return false;
+    }
+    return true;
+}
+
+bool ImageWriter::writePNG(const std::string& filename, uint32_t width, uint32_t height,
+                           const std::vector<uint8_t>& rgba) {
+    if (rgba.size() < static_cast<size_t>(width) * height * 4) {
+        Logger::error("Not enough pixel data for {}x{} image: {}", width, height, filename);
+        return false;
+    }
+
+    // Raw scanlines: filter type 0 followed by RGB bytes
+    size_t rowSize = static_cast<size_t>(width) * 3 + 1;
+    std::vector<uint8_t> raw(rowSize * height);
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t* dst = raw.data() + y * rowSize;
+        const uint8_t* src = rgba.data() + static_cast<size_t>(y) * width * 4;
+        dst[0] = 0;
+        for (uint32_t x = 0; x < width; x++) {
+            dst[1 + x * 3 + 0] = src[x * 4 + 0];
+            dst[1 + x * 3 + 1] = src[x * 4 + 1];
+            dst[1 + x * 3 + 2] = src[x * 4 + 2];
+        }
+    }
+
+    // zlib stream made of stored deflate blocks (max 65535 bytes each)
+    const size_t maxBlock = 65535;
+    std::vector<uint8_t> zlib;
+    zlib.reserve(raw.size() + raw.size() / maxBlock * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    uint32_t adlerA = 1;
+    uint32_t adlerB = 0;
+    size_t offset = 0;
+    do {
+        size_t blockSize = (std::min)(maxBlock, raw.size() - offset);
+        bool lastBlock = offset + blockSize == raw.size();
+        zlib.push_back(lastBlock ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(blockSize));
+        zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+        zlib.push_back(static_cast<uint8_t>(~blockSize));
+        zlib.push_back(static_cast<uint8_t>(~blockSize >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        for (size_t i = offset; i < offset + blockSize; i++) {
+            adlerA = (adlerA + raw[i]) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+        offset += blockSize;
+    } while (offset < raw.size());
+    appendBigEndian(zlib, (adlerB << 16) | adlerA);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        Logger::error("Failed to open image for writing: {}", filename);
+        return false;
+    }
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> header;
+    appendBigEndian(header, width);
+    appendBigEndian(header, height);
+    header.push_back(8);    // bit depth
+    header.push_back(2);    // color type: RGB
+    header.push_back(0);    // compression
+    header.push_back(0);    // filter
+    header.push_back(0);    // interlace
+    writeChunk(file, "IHDR", header);
+    writeChunk(file, "IDAT", zlib);
+    writeChunk(file, "IEND", {});
+
+    file.close();
+    if (!file) {
+        Logger::error("Failed to write image: {}", filename);
+        return false;
+    }
+    return true;
+}
+
+bool ImageWriter::write(const std::string& filename, uint32_t width, uint32_t height,
+                        const std::vector<uint8_t>& rgba) {
+    std::string extension;
+    size_t dot = filename.find_last_of('.');
+    if (dot != std::string::npos) {
+        extension = filename.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    }
+
+    if (extension == "png") {
+        return writePNG(filename, width, height, rgba);
+    }
+    return writePPM(filename, width, height, rgba);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Writes tightly packed RGBA8 pixels (top row first) to image files
+class ImageWriter {
+public:
+    // Binary PPM (P6); the alpha channel is dropped
+    static bool writePPM(const std::string& filename, uint32_t width, uint32_t height,
+                         const std::vector<uint8_t>& rgba);
+
+    // 8-bit RGB PNG. Image data is stored in uncompressed deflate blocks, which
+    // keeps encoding cheap and dependency-free at the cost of file size.
+    static bool writePNG(const std::string& filename, uint32_t width, uint32_t height,
+                         const std::vector<uint8_t>& rgba);
+
+    // Picks the format from the file extension (.png, otherwise PPM)
+    static bool write(const std::string& filename, uint32_t width, uint32_t height,
+                      const std::vector<uint8_t>& rgba);
+};
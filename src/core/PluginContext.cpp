@@ -2,5 +2,58 @@
 #include "VulkanContext.h"
 #include "Renderer.h"
 #include "Camera.h"
+#include "PointCache.h"
+#include "Logger.h"
+#include <algorithm>
 
-// All implementations are now inline in the header file
+// Simple accessors are inline in the header file
+
+size_t PluginContext::getPointCount() const {
+    if (m_pointCache) {
+        return m_pointCache->getPointCount();
+    }
+    return m_pointCloudData.size();
+}
+
+PluginPointData PluginContext::getPoint(size_t index) const {
+    if (!m_pointCache) {
+        return m_pointCloudData[index];
+    }
+
+    const float* position = m_pointCache->getPositions() + index * 3;
+    const float* color = m_pointCache->getColors() + index * 3;
+
+    PluginPointData point;
+    point.x = position[0];
+    point.y = position[1];
+    point.z = position[2];
+    point.r = color[0];
+    point.g = color[1];
+    point.b = color[2];
+    point.size = m_pointCache->getSizes()[index];
+    return point;
+}
+
+bool PluginContext::loadPointCache(const std::string& filename) {
+    std::shared_ptr<PointCache> cache = PointCache::open(filename);
+    if (!cache) {
+        return false;
+    }
+
+    m_pointCloudData.clear();
+    m_pointCache = cache;
+    m_selectedPointIndex = -1;
+    m_pointCloudDirty = true;
+    return true;
+}
+
+bool PluginContext::setPointLabels(size_t first, const std::vector<uint32_t>& labels) {
+    if (first > m_pointLabels.size() || labels.size() > m_pointLabels.size() - first) {
+        Logger::warn("Point label range {}+{} is outside the {} labels", first, labels.size(), m_pointLabels.size());
+        return false;
+    }
+    std::copy(labels.begin(), labels.end(), m_pointLabels.begin() + first);
+    m_dirtyPointLabelRanges.push_back(PointLabelRange{first, labels.size()});
+    m_pointLabelsDirty = true;
+    return true;
+}
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <functional>
+#include <memory>
+#include <string>
 
 class VulkanContext;
 class Renderer;
 class Camera;
+class PointCache;
 
 // Point data structure for plugins to submit
 struct PluginPointData {
@@ -18,7 +22,8 @@ class PluginContext {
 public:
     PluginContext(VulkanContext* vulkanContext, Renderer* renderer, Camera* camera)
         : m_vulkanContext(vulkanContext), m_renderer(renderer), m_camera(camera),
-          m_pointCloudDirty(false), m_selectedPointIndex(-1), m_selectionDirty(false) {}
+          m_pointCloudDirty(false), m_pointLabelsDirty(false), m_selectedPointIndex(-1), m_selectionDirty(false),
+          m_redrawRequested(false) {}
 
     VulkanContext* getVulkanContext() const { return m_vulkanContext; }
     Renderer* getRenderer() const { return m_renderer; }
@@ -27,16 +32,55 @@ public:
     // Point cloud interface for plugins - inline implementation
     void setPointCloudData(const std::vector<PluginPointData>& points) {
         m_pointCloudData = points;
+        m_pointCache.reset();
         m_pointCloudDirty = true;
     }
 
     const std::vector<PluginPointData>& getPointCloudData() const { return m_pointCloudData; }
-    bool hasPointCloudData() const { return !m_pointCloudData.empty(); }
-    void clearPointCloudData() { m_pointCloudData.clear(); m_pointCloudDirty = true; }
+    bool hasPointCloudData() const { return getPointCount() > 0; }
+    void clearPointCloudData() { m_pointCloudData.clear(); m_pointCache.reset(); m_pointCloudDirty = true; }
+
+    // Access to the active point set, whether it came from a plugin or a point cache
+    size_t getPointCount() const;
+    PluginPointData getPoint(size_t index) const;
+
+    // Binary point cache: loading maps the file and replaces the current points
+    // without copying (saving is PointCacheWriter::save)
+    bool loadPointCache(const std::string& filename);
+    const std::shared_ptr<PointCache>& getPointCache() const { return m_pointCache; }
 
     bool isPointCloudDirty() const { return m_pointCloudDirty; }
     void setPointCloudDirty(bool dirty) { m_pointCloudDirty = dirty; }
 
+    // Optional label id per point (0 = unlabelled), indexed like getPoint().
+    // Labels are a separate column: changing them does not re-upload the
+    // points, and they are ignored unless there is one per point
+    struct PointLabelRange {
+        size_t first;
+        size_t count;
+    };
+    void setPointLabels(const std::vector<uint32_t>& labels) {
+        m_pointLabels = labels;
+        m_dirtyPointLabelRanges.assign(1, PointLabelRange{0, labels.size()});
+        m_pointLabelsDirty = true;
+    }
+    // Change the labels of points [first, first + labels.size()) only, so the
+    // renderer re-uploads just those. Returns false if the range is outside
+    // the current labels
+    bool setPointLabels(size_t first, const std::vector<uint32_t>& labels);
+    void clearPointLabels() { m_pointLabels.clear(); m_dirtyPointLabelRanges.clear(); m_pointLabelsDirty = true; }
+    const std::vector<uint32_t>& getPointLabels() const { return m_pointLabels; }
+    bool hasPointLabels() const { return !m_pointLabels.empty() && m_pointLabels.size() == getPointCount(); }
+    bool isPointLabelsDirty() const { return m_pointLabelsDirty; }
+    void setPointLabelsDirty(bool dirty) {
+        m_pointLabelsDirty = dirty;
+        if (!dirty) {
+            m_dirtyPointLabelRanges.clear();
+        }
+    }
+    // Point ranges whose labels changed since the labels were last marked clean
+    const std::vector<PointLabelRange>& getDirtyPointLabelRanges() const { return m_dirtyPointLabelRanges; }
+
     // Point selection interface
     void setSelectedPointIndex(int index) {
         m_selectedPointIndex = index;
@@ -46,14 +90,26 @@ public:
     bool isSelectionDirty() const { return m_selectionDirty; }
     void setSelectionDirty(bool dirty) { m_selectionDirty = dirty; }
 
+    // Redraw interface: with on-demand rendering the viewer only renders when
+    // something changed; plugins that animate call requestRedraw() every update
+    void requestRedraw() { m_redrawRequested = true; }
+    bool needsRedraw() const { return m_redrawRequested || m_pointCloudDirty || m_pointLabelsDirty || m_selectionDirty; }
+    void clearRedrawRequest() { m_redrawRequested = false; }
+
 private:
     VulkanContext* m_vulkanContext;
     Renderer* m_renderer;
     Camera* m_camera;
 
     std::vector<PluginPointData> m_pointCloudData;
+    std::shared_ptr<PointCache> m_pointCache;  // Takes precedence over m_pointCloudData when set
     bool m_pointCloudDirty = false;
+    std::vector<uint32_t> m_pointLabels;
+    std::vector<PointLabelRange> m_dirtyPointLabelRanges;
+    bool m_pointLabelsDirty = false;
 
     int m_selectedPointIndex = -1;  // -1 means no selection
     bool m_selectionDirty = false;
+
+    bool m_redrawRequested = false;
 };
@@ -0,0 +1,297 @@
+#include "PointCache.h"
+#include "Logger.h"
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+const char POINT_CACHE_MAGIC[8] = { 'F', 'L', 'P', 'C', 'A', 'C', 'H', 'E' };
+
+bool isLittleEndianHost() {
+    const uint32_t probe = 1;
+    uint8_t firstByte;
+    std::memcpy(&firstByte, &probe, 1);
+    return firstByte == 1;
+}
+
+uint64_t alignUp(uint64_t value) {
+    return (value + POINT_CACHE_ALIGNMENT - 1) & ~(POINT_CACHE_ALIGNMENT - 1);
+}
+
+// A section of 'count' elements starting at 'offset' lies inside the file and
+// is aligned for its element type. Written without 'offset + count * size' so
+// a crafted header cannot overflow past the checks.
+bool isSectionValid(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t elementAlignment,
+                    uint64_t fileSize) {
+    if (offset % elementAlignment != 0 || offset > fileSize) {
+        return false;
+    }
+    return count <= (fileSize - offset) / elementSize;
+}
+
+void writePadding(std::ofstream& file, uint64_t currentOffset, uint64_t targetOffset) {
+    static const char zeros[POINT_CACHE_ALIGNMENT] = {};
+    file.write(zeros, static_cast<std::streamsize>(targetOffset - currentOffset));
+}
+
+} // namespace
+
+PointCache::~PointCache() {
+    unmap();
+}
+
+std::shared_ptr<PointCache> PointCache::open(const std::string& filename) {
+    if (!isLittleEndianHost()) {
+        Logger::error("Point cache files are little-endian only, cannot open: {}", filename);
+        return nullptr;
+    }
+
+    std::shared_ptr<PointCache> cache(new PointCache());
+    if (!cache->map(filename) || !cache->validate()) {
+        return nullptr;
+    }
+
+    Logger::info("Point cache opened: {} ({} points, {} chunks)",
+                 filename, cache->getPointCount(), cache->getChunkCount());
+    return cache;
+}
+
+bool PointCache::map(const std::string& filename) {
+    m_filename = filename;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        Logger::error("Failed to open point cache: {}", filename);
+        return false;
+    }
+    m_fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        Logger::error("Failed to get point cache size: {}", filename);
+        return false;
+    }
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        Logger::error("Failed to create point cache mapping: {}", filename);
+        return false;
+    }
+    m_mappingHandle = mapping;
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) {
+        Logger::error("Failed to map point cache: {}", filename);
+        return false;
+    }
+#else
+    m_fd = ::open(filename.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        Logger::error("Failed to open point cache: {}", filename);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || st.st_size == 0) {
+        Logger::error("Failed to get point cache size: {}", filename);
+        return false;
+    }
+    m_size = static_cast<size_t>(st.st_size);
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED) {
+        Logger::error("Failed to map point cache: {}", filename);
+        return false;
+    }
+    m_data = static_cast<const uint8_t*>(data);
+#endif
+
+    return true;
+}
+
+bool PointCache::validate() {
+    if (m_size < sizeof(PointCacheHeader)) {
+        Logger::error("Point cache is truncated: {}", m_filename);
+        return false;
+    }
+
+    m_header = reinterpret_cast<const PointCacheHeader*>(m_data);
+    if (std::memcmp(m_header->magic, POINT_CACHE_MAGIC, sizeof(POINT_CACHE_MAGIC)) != 0) {
+        Logger::error("Not a point cache file: {}", m_filename);
+        return false;
+    }
+    if (m_header->version != VERSION || m_header->headerSize != sizeof(PointCacheHeader)) {
+        Logger::error("Unsupported point cache version {} in {} (expected {})",
+                      m_header->version, m_filename, VERSION);
+        return false;
+    }
+    if (m_header->fileSize != m_size) {
+        Logger::error("Point cache size mismatch in {}: header says {} bytes, file has {}",
+                      m_filename, m_header->fileSize, m_size);
+        return false;
+    }
+
+    const uint64_t pointCount = m_header->pointCount;
+    if (pointCount > (std::numeric_limits<uint32_t>::max)()) {
+        Logger::error("Point cache has too many points: {}", m_filename);
+        return false;
+    }
+    if (!isSectionValid(m_header->chunkOffset, m_header->chunkCount, sizeof(PointCacheChunk),
+                        alignof(PointCacheChunk), m_size) ||
+        !isSectionValid(m_header->positionOffset, pointCount, sizeof(float) * 3, alignof(float), m_size) ||
+        !isSectionValid(m_header->colorOffset, pointCount, sizeof(float) * 3, alignof(float), m_size) ||
+        !isSectionValid(m_header->sizeOffset, pointCount, sizeof(float), alignof(float), m_size)) {
+        Logger::error("Point cache sections are out of range or misaligned: {}", m_filename);
+        return false;
+    }
+
+    m_chunks = reinterpret_cast<const PointCacheChunk*>(m_data + m_header->chunkOffset);
+    std::vector<uint8_t> hasParent(m_header->chunkCount, 0);
+    for (uint32_t c = 0; c < m_header->chunkCount; c++) {
+        const PointCacheChunk& chunk = m_chunks[c];
+        if (static_cast<uint64_t>(chunk.firstPoint) + chunk.pointCount > pointCount ||
+            static_cast<uint64_t>(chunk.firstChild) + chunk.childCount > m_header->chunkCount) {
+            Logger::error("Point cache chunk {} is out of range: {}", c, m_filename);
+            return false;
+        }
+
+        // The hierarchy must be a tree rooted at chunk 0: children come after
+        // their parent and have no other parent, so traversals terminate
+        if (chunk.childCount > 0 && chunk.firstChild <= c) {
+            Logger::error("Point cache chunk {} has children before it: {}", c, m_filename);
+            return false;
+        }
+        for (uint32_t child = chunk.firstChild; child < chunk.firstChild + chunk.childCount; child++) {
+            if (hasParent[child]) {
+                Logger::error("Point cache chunk {} has more than one parent: {}", child, m_filename);
+                return false;
+            }
+            hasParent[child] = 1;
+        }
+    }
+    for (uint32_t c = 1; c < m_header->chunkCount; c++) {
+        if (!hasParent[c]) {
+            Logger::error("Point cache chunk {} is not part of the hierarchy: {}", c, m_filename);
+            return false;
+        }
+    }
+
+    m_positions = reinterpret_cast<const float*>(m_data + m_header->positionOffset);
+    m_colors = reinterpret_cast<const float*>(m_data + m_header->colorOffset);
+    m_sizes = reinterpret_cast<const float*>(m_data + m_header->sizeOffset);
+    return true;
+}
+
+void PointCache::unmap() {
+#ifdef _WIN32
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mappingHandle) {
+        CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+        m_mappingHandle = nullptr;
+    }
+    if (m_fileHandle) {
+        CloseHandle(static_cast<HANDLE>(m_fileHandle));
+        m_fileHandle = nullptr;
+    }
+#else
+    if (m_data) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_chunks = nullptr;
+    m_positions = nullptr;
+    m_colors = nullptr;
+    m_sizes = nullptr;
+}
+
+bool PointCache::write(const std::string& filename, const std::vector<PointCacheChunk>& chunks,
+                       const std::vector<float>& positions, const std::vector<float>& colors,
+                       const std::vector<float>& sizes, uint32_t chunkSize) {
+    if (!isLittleEndianHost()) {
+        Logger::error("Point cache files are little-endian only, cannot write: {}", filename);
+        return false;
+    }
+
+    const uint64_t pointCount = sizes.size();
+    if (pointCount > (std::numeric_limits<uint32_t>::max)()) {
+        Logger::error("Too many points for a point cache: {}", pointCount);
+        return false;
+    }
+    if (positions.size() != pointCount * 3 || colors.size() != pointCount * 3) {
+        Logger::error("Point cache columns have different lengths: {}", filename);
+        return false;
+    }
+    const uint32_t chunkCount = static_cast<uint32_t>(chunks.size());
+
+    PointCacheHeader header{};
+    std::memcpy(header.magic, POINT_CACHE_MAGIC, sizeof(POINT_CACHE_MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(PointCacheHeader);
+    header.pointCount = pointCount;
+    header.chunkSize = chunkSize;
+    header.chunkCount = chunkCount;
+    header.chunkOffset = alignUp(sizeof(PointCacheHeader));
+    header.positionOffset = alignUp(header.chunkOffset + sizeof(PointCacheChunk) * chunkCount);
+    header.colorOffset = alignUp(header.positionOffset + sizeof(float) * 3 * pointCount);
+    header.sizeOffset = alignUp(header.colorOffset + sizeof(float) * 3 * pointCount);
+    header.fileSize = header.sizeOffset + sizeof(float) * pointCount;
+    if (chunkCount > 0) {
+        for (int axis = 0; axis < 3; axis++) {
+            header.boundsMin[axis] = chunks[0].boundsMin[axis];
+            header.boundsMax[axis] = chunks[0].boundsMax[axis];
+        }
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        Logger::error("Failed to open point cache for writing: {}", filename);
+        return false;
+    }
+
+    uint64_t offset = 0;
+    auto writeSection = [&](uint64_t sectionOffset, const void* data, uint64_t size) {
+        writePadding(file, offset, sectionOffset);
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        offset = sectionOffset + size;
+    };
+
+    writeSection(0, &header, sizeof(header));
+    writeSection(header.chunkOffset, chunks.data(), sizeof(PointCacheChunk) * chunks.size());
+    writeSection(header.positionOffset, positions.data(), sizeof(float) * positions.size());
+    writeSection(header.colorOffset, colors.data(), sizeof(float) * colors.size());
+    writeSection(header.sizeOffset, sizes.data(), sizeof(float) * sizes.size());
+
+    file.close();
+    if (!file) {
+        Logger::error("Failed to write point cache: {}", filename);
+        return false;
+    }
+
+    Logger::info("Point cache written: {} ({} points, {} chunks)", filename, pointCount, chunkCount);
+    return true;
+}
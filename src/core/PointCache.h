@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Binary point cache file layout (version 2, all fields little-endian):
+//
+//   PointCacheHeader
+//   PointCacheChunk[chunkCount]          LOD hierarchy nodes, root first
+//   position column  float[3] * pointCount
+//   color column     float[3] * pointCount
+//   size column      float    * pointCount
+//
+// Every section starts on a POINT_CACHE_ALIGNMENT boundary, so the columns can
+// be used directly from the memory mapping and copied into GPU buffers as-is.
+static constexpr uint64_t POINT_CACHE_ALIGNMENT = 64;
+
+struct PointCacheHeader {
+    char magic[8];              // "FLPCACHE"
+    uint32_t version;
+    uint32_t headerSize;        // sizeof(PointCacheHeader), for sanity checks
+    uint64_t pointCount;
+    uint32_t chunkSize;         // max points per chunk the hierarchy was built with
+    uint32_t chunkCount;
+    uint64_t chunkOffset;
+    uint64_t positionOffset;
+    uint64_t colorOffset;
+    uint64_t sizeOffset;
+    uint64_t fileSize;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+// One node of the point LOD hierarchy (see PointOctreeNode). Points are
+// stored in node order, so the point range of every chunk is contiguous.
+struct PointCacheChunk {
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t firstPoint;
+    uint32_t pointCount;
+    uint32_t firstChild;
+    uint32_t childCount;
+};
+
+class PointCache {
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t DEFAULT_CHUNK_SIZE = 16384;
+
+    ~PointCache();
+
+    // Memory-map an existing cache file. Returns nullptr if the file is missing,
+    // truncated or was written with a different version.
+    static std::shared_ptr<PointCache> open(const std::string& filename);
+
+    // Write a cache file from a hierarchy and its columns, both in node order
+    // (positions and colors are 3 floats per point). PointCacheWriter builds
+    // them from plugin points.
+    static bool write(const std::string& filename, const std::vector<PointCacheChunk>& chunks,
+                      const std::vector<float>& positions, const std::vector<float>& colors,
+                      const std::vector<float>& sizes, uint32_t chunkSize);
+
+    const std::string& getFilename() const { return m_filename; }
+    const PointCacheHeader& getHeader() const { return *m_header; }
+    size_t getPointCount() const { return static_cast<size_t>(m_header->pointCount); }
+
+    // Column pointers into the mapping (positions and colors are 3 floats per point)
+    const float* getPositions() const { return m_positions; }
+    const float* getColors() const { return m_colors; }
+    const float* getSizes() const { return m_sizes; }
+
+    const PointCacheChunk* getChunks() const { return m_chunks; }
+    uint32_t getChunkCount() const { return m_header->chunkCount; }
+
+private:
+    PointCache() = default;
+    PointCache(const PointCache&) = delete;
+    PointCache& operator=(const PointCache&) = delete;
+
+    bool map(const std::string& filename);
+    bool validate();
+    void unmap();
+
+    std::string m_filename;
+
+    // Mapping
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#else
+    int m_fd = -1;
+#endif
+
+    // Views into the mapping
+    const PointCacheHeader* m_header = nullptr;
+    const PointCacheChunk* m_chunks = nullptr;
+    const float* m_positions = nullptr;
+    const float* m_colors = nullptr;
+    const float* m_sizes = nullptr;
+};
@@ -3,6 +3,7 @@
 #include "UI.h"
 #include "Logger.h"
 #include "PluginContext.h"
+#include "VulkanContext.h"
 #include <imgui.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <limits>
@@ -32,12 +33,24 @@ void InputHandler::init() {
     glfwSetScrollCallback(m_window, scrollCallback);
     glfwSetKeyCallback(m_window, keyCallback);
     glfwSetWindowSizeCallback(m_window, windowSizeCallback);
+    glfwSetFramebufferSizeCallback(m_window, framebufferSizeCallback);
+    glfwSetWindowRefreshCallback(m_window, windowRefreshCallback);
 }
 
 void InputHandler::pollEvents() {
     glfwPollEvents();
 }
 
+void InputHandler::waitEvents(double timeout) {
+    glfwWaitEventsTimeout(timeout);
+}
+
+bool InputHandler::consumeEvents() {
+    bool hadEvents = m_eventCount > 0;
+    m_eventCount = 0;
+    return hadEvents;
+}
+
 bool InputHandler::isUIInteraction() const {
     // 添加对m_ui指针的检查日志
     if (!m_ui) {
@@ -84,6 +97,8 @@ bool InputHandler::isUIInteraction() const {
 
 void InputHandler::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     if (s_instance) {
+        s_instance->m_eventCount++;
+
         // Check if interacting with UI elements
         bool isUIInteraction = s_instance->isUIInteraction();
 
@@ -101,6 +116,7 @@ void InputHandler::mouseButtonCallback(GLFWwindow* window, int button, int actio
 
 void InputHandler::mouseMoveCallback(GLFWwindow* window, double xpos, double ypos) {
     if (s_instance) {
+        s_instance->m_eventCount++;
         glm::vec2 currentPos((float)xpos, (float)ypos);
         s_instance->m_lastMousePos = currentPos;
         
@@ -111,6 +127,8 @@ void InputHandler::mouseMoveCallback(GLFWwindow* window, double xpos, double ypo
 
 void InputHandler::scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
     if (s_instance) {
+        s_instance->m_eventCount++;
+
         // Camera zoom disabled for redesign
         // TODO: Implement new camera zoom system
     }
@@ -121,6 +139,10 @@ void InputHandler::keyCallback(GLFWwindow* window, int key, int scancode, int ac
         glfwSetWindowShouldClose(window, GLFW_TRUE);
     }
 
+    if (s_instance) {
+        s_instance->m_eventCount++;
+    }
+
     // 添加更多键盘快捷键
     if (s_instance && action == GLFW_PRESS) {
         if (key == GLFW_KEY_R) {
@@ -152,7 +174,27 @@ void InputHandler::keyCallback(GLFWwindow* window, int key, int scancode, int ac
 }
 
 void InputHandler::windowSizeCallback(GLFWwindow* window, int width, int height) {
-    // Window resize handling
+    // 交换链在下一帧开始时按新的帧缓冲区大小重建
+    if (s_instance) {
+        s_instance->m_eventCount++;
+    }
+    if (s_instance && s_instance->m_vulkanContext) {
+        s_instance->m_vulkanContext->setFramebufferResized();
+    }
+}
+
+void InputHandler::framebufferSizeCallback(GLFWwindow* window, int width, int height) {
+    // 高DPI显示器上帧缓冲区大小可能与窗口大小不同
+    if (s_instance && s_instance->m_vulkanContext) {
+        s_instance->m_vulkanContext->setFramebufferResized();
+    }
+}
+
+void InputHandler::windowRefreshCallback(GLFWwindow* window) {
+    // 窗口内容需要重绘（例如被遮挡后重新显示）
+    if (s_instance) {
+        s_instance->m_eventCount++;
+    }
 }
 
 void InputHandler::pickPoint(double mouseX, double mouseY) {
@@ -169,14 +211,14 @@ void InputHandler::pickPoint(double mouseX, double mouseY) {
     glm::mat4 projMatrix = m_camera->getProjectionMatrix();
     glm::mat4 vpMatrix = projMatrix * viewMatrix;
 
-    const auto& points = m_pluginContext->getPointCloudData();
+    size_t pointCount = m_pluginContext->getPointCount();
 
     float minDist = (std::numeric_limits<float>::max)();
     int closestIndex = -1;
 
     // Find closest point to mouse position in screen space
-    for (size_t i = 0; i < points.size(); i++) {
-        const auto& pt = points[i];
+    for (size_t i = 0; i < pointCount; i++) {
+        const PluginPointData pt = m_pluginContext->getPoint(i);
         glm::vec4 worldPos(pt.x, pt.y, pt.z, 1.0f);
 
         // Transform to clip space
@@ -207,7 +249,7 @@ void InputHandler::pickPoint(double mouseX, double mouseY) {
     // Check if click is close enough to a point (within 20 pixels)
     float threshold = 20.0f * 20.0f;  // squared distance
     if (closestIndex >= 0 && minDist < threshold) {
-        const auto& pt = points[closestIndex];
+        const PluginPointData pt = m_pluginContext->getPoint(closestIndex);
 
         // Print coordinates to console
         Logger::info("[Point Selected] Index: {} | X: {:.2f}, Y: {:.2f}, Z: {:.2f} | Color: ({:.2f}, {:.2f}, {:.2f})",
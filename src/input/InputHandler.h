@@ -6,6 +6,7 @@
 class Camera;
 class UI;
 class PluginContext;
+class VulkanContext;
 
 class InputHandler {
 public:
@@ -14,8 +15,14 @@ public:
 
     void init();
     void pollEvents();
+    // Block until an event arrives or the timeout (seconds) expires
+    void waitEvents(double timeout);
+    // True if any input or window event was received since the last call
+    bool consumeEvents();
     void setUI(UI* ui);
     void setPluginContext(PluginContext* context) { m_pluginContext = context; }
+    // Resize events mark the swapchain for recreation
+    void setVulkanContext(VulkanContext* context) { m_vulkanContext = context; }
 
 private:
     // Mouse event callbacks
@@ -26,8 +33,10 @@ private:
     // Keyboard event callback
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
-    // Window resize callback
+    // Window resize callbacks
     static void windowSizeCallback(GLFWwindow* window, int width, int height);
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+    static void windowRefreshCallback(GLFWwindow* window);
 
     // UI interaction detection
     bool isUIInteraction() const;
@@ -39,12 +48,16 @@ private:
     Camera* m_camera;
     UI* m_ui;
     PluginContext* m_pluginContext = nullptr;
+    VulkanContext* m_vulkanContext = nullptr;
 
     // Mouse state
     bool m_isRotating;
     bool m_isPanning;
     glm::vec2 m_lastMousePos;
 
+    // Number of input/window events since the last consumeEvents()
+    unsigned int m_eventCount = 0;
+
     // Static instance pointer for callbacks
     static InputHandler* s_instance;
 };
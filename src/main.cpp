@@ -1,13 +1,26 @@
 #include "core/Application.h"
+#include "core/BatchRenderer.h"
 #include "core/Logger.h"
 #include <iostream>
 
-int main() {
+int main(int argc, char** argv) {
     try {
         // 初始化日志系统
         Logger::init();
         
         Application app("GLFW + ImGui + Vulkan Demo", 800, 600);
+
+        // 批量缩略图模式：demo --batch list.txt [--view NAME] [--size WxH] [--output DIR] [--format png|ppm]
+        if (argc > 1) {
+            BatchOptions batchOptions;
+            if (!BatchOptions::parse(argc, argv, batchOptions)) {
+                Logger::error("Usage: {} --batch <list> [--view <name>] [--size <w>x<h>] [--output <dir>] "
+                              "[--format png|ppm] [--threads <n>]", argv[0]);
+                return EXIT_FAILURE;
+            }
+            app.setBatchOptions(batchOptions);
+        }
+
         app.run();
         return 0;
     } catch (const std::exception& e) {
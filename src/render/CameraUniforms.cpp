@@ -0,0 +1,121 @@
+#include "CameraUniforms.h"
+#include "VulkanContext.h"
+#include "Camera.h"
+#include "Logger.h"
+#include <cstring>
+#include <stdexcept>
+
+CameraUniforms::CameraUniforms(VulkanContext* vulkanContext, Camera* camera)
+    : m_vulkanContext(vulkanContext), m_camera(camera),
+      m_descriptorSetLayout(VK_NULL_HANDLE), m_descriptorPool(VK_NULL_HANDLE),
+      m_buffer(VK_NULL_HANDLE), m_mapped(nullptr), m_slotStride(0) {}
+
+CameraUniforms::~CameraUniforms() {
+    cleanup();
+}
+
+bool CameraUniforms::init() {
+    try {
+        VkDevice device = m_vulkanContext->getDevice();
+        uint32_t slotCount = m_vulkanContext->getFrameCount();
+
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = 0;
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        binding.descriptorCount = 1;
+        binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &binding;
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create camera descriptor set layout!");
+        }
+
+        // Slots are placed at the device's uniform buffer offset alignment
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(m_vulkanContext->getPhysicalDevice(), &properties);
+        VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+        if (alignment == 0) {
+            alignment = 1;
+        }
+        m_slotStride = (sizeof(CameraUniformData) + alignment - 1) / alignment * alignment;
+
+        m_vulkanContext->getAllocator().createBuffer(m_slotStride * slotCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_buffer, m_memory);
+        m_mapped = static_cast<uint8_t*>(m_memory.mapped);
+
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        poolSize.descriptorCount = slotCount;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = slotCount;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create camera descriptor pool!");
+        }
+
+        std::vector<VkDescriptorSetLayout> layouts(slotCount, m_descriptorSetLayout);
+        VkDescriptorSetAllocateInfo setInfo{};
+        setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        setInfo.descriptorPool = m_descriptorPool;
+        setInfo.descriptorSetCount = slotCount;
+        setInfo.pSetLayouts = layouts.data();
+        m_descriptorSets.resize(slotCount);
+        if (vkAllocateDescriptorSets(device, &setInfo, m_descriptorSets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate camera descriptor sets!");
+        }
+
+        for (uint32_t slot = 0; slot < slotCount; slot++) {
+            VkDescriptorBufferInfo bufferDescriptor{};
+            bufferDescriptor.buffer = m_buffer;
+            bufferDescriptor.offset = m_slotStride * slot;
+            bufferDescriptor.range = sizeof(CameraUniformData);
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = m_descriptorSets[slot];
+            write.dstBinding = 0;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            write.pBufferInfo = &bufferDescriptor;
+            vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+            update(slot);
+        }
+        return true;
+    } catch (const std::exception& e) {
+        Logger::error("CameraUniforms initialization error: {}", e.what());
+        cleanup();
+        return false;
+    }
+}
+
+void CameraUniforms::update(uint32_t frameSlot) {
+    CameraUniformData data;
+    data.viewProjection = m_camera->getViewProjectionMatrix();
+    data.view = m_camera->getViewMatrix();
+    data.projection = m_camera->getProjectionMatrix();
+    std::memcpy(m_mapped + m_slotStride * frameSlot, &data, sizeof(data));
+}
+
+void CameraUniforms::cleanup() {
+    VkDevice device = m_vulkanContext->getDevice();
+
+    // Destroying the pool frees the descriptor sets
+    if (m_descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, m_descriptorPool, nullptr);
+        m_descriptorPool = VK_NULL_HANDLE;
+    }
+    m_descriptorSets.clear();
+    m_vulkanContext->getAllocator().destroyBuffer(m_buffer, m_memory);
+    m_mapped = nullptr;
+    if (m_descriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, m_descriptorSetLayout, nullptr);
+        m_descriptorSetLayout = VK_NULL_HANDLE;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include "GpuAllocator.h"
+
+class VulkanContext;
+class Camera;
+
+// Camera matrices as seen by the shaders (set 0, binding 0)
+struct CameraUniformData {
+    glm::mat4 viewProjection;
+    glm::mat4 view;
+    glm::mat4 projection;
+};
+
+// Per-frame-in-flight uniform buffer with the camera matrices. Draws that read
+// the camera from a slot's descriptor set instead of push constants see the
+// matrices at execution time, so their command buffers stay valid while the
+// camera moves and can be recorded once and reused.
+class CameraUniforms {
+public:
+    CameraUniforms(VulkanContext* vulkanContext, Camera* camera);
+    ~CameraUniforms();
+
+    bool init();
+    void cleanup();
+
+    // Copy the current camera matrices into a slot whose fence has been waited on
+    void update(uint32_t frameSlot);
+
+    VkDescriptorSetLayout getDescriptorSetLayout() const { return m_descriptorSetLayout; }
+    VkDescriptorSet getDescriptorSet(uint32_t frameSlot) const { return m_descriptorSets[frameSlot]; }
+
+private:
+    VulkanContext* m_vulkanContext;
+    Camera* m_camera;
+
+    VkDescriptorSetLayout m_descriptorSetLayout;
+    VkDescriptorPool m_descriptorPool;
+    std::vector<VkDescriptorSet> m_descriptorSets;
+
+    // One buffer holding every slot at m_slotStride intervals, persistently mapped
+    VkBuffer m_buffer;
+    GpuAllocation m_memory;
+    uint8_t* m_mapped;
+    VkDeviceSize m_slotStride;
+};
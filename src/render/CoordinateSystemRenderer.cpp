@@ -1,6 +1,7 @@
 #include "CoordinateSystemRenderer.h"
 #include "VulkanContext.h"
 #include "Camera.h"
+#include "CameraUniforms.h"
 #include "Logger.h"
 #include "ShaderCompiler.h"
 #include <stdexcept>
@@ -9,15 +10,13 @@
 #include <array>
 #include <glm/gtc/matrix_transform.hpp>
 
-CoordinateSystemRenderer::CoordinateSystemRenderer(VulkanContext* vulkanContext, Camera* camera)
-    : m_vulkanContext(vulkanContext), m_camera(camera),
-      m_vertexBuffer(VK_NULL_HANDLE), m_vertexBufferMemory(VK_NULL_HANDLE),
-      m_indexBuffer(VK_NULL_HANDLE), m_indexBufferMemory(VK_NULL_HANDLE),
+CoordinateSystemRenderer::CoordinateSystemRenderer(VulkanContext* vulkanContext, Camera* camera, CameraUniforms* cameraUniforms)
+    : m_vulkanContext(vulkanContext), m_camera(camera), m_cameraUniforms(cameraUniforms),
+      m_vertexBuffer(VK_NULL_HANDLE), m_indexBuffer(VK_NULL_HANDLE),
       m_vertexShaderModule(VK_NULL_HANDLE), m_fragmentShaderModule(VK_NULL_HANDLE),
       m_pipelineLayout(VK_NULL_HANDLE), m_graphicsPipeline(VK_NULL_HANDLE),
       m_descriptorSetLayout(VK_NULL_HANDLE), m_descriptorPool(VK_NULL_HANDLE),
-      m_descriptorSet(VK_NULL_HANDLE),
-      m_uniformBuffer(VK_NULL_HANDLE), m_uniformBufferMemory(VK_NULL_HANDLE) {
+      m_descriptorSet(VK_NULL_HANDLE) {
 }
 
 CoordinateSystemRenderer::~CoordinateSystemRenderer() {
@@ -175,103 +174,13 @@ void CoordinateSystemRenderer::createVertexBuffer() {
     
     VkDeviceSize bufferSize = sizeof(m_vertices[0]) * m_vertices.size();
     
-    // 创建临时缓冲区用于复制数据
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = bufferSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    
-    if (vkCreateBuffer(m_vulkanContext->getDevice(), &bufferInfo, nullptr, &stagingBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create staging buffer!");
-    }
-    
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(m_vulkanContext->getDevice(), stagingBuffer, &memRequirements);
-    
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    
-    if (vkAllocateMemory(m_vulkanContext->getDevice(), &allocInfo, nullptr, &stagingBufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate staging buffer memory!");
-    }
-    
-    vkBindBufferMemory(m_vulkanContext->getDevice(), stagingBuffer, stagingBufferMemory, 0);
-    
-    // 将顶点数据复制到缓冲区
-    void* data;
-    vkMapMemory(m_vulkanContext->getDevice(), stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, m_vertices.data(), (size_t)bufferSize);
-    vkUnmapMemory(m_vulkanContext->getDevice(), stagingBufferMemory);
-    
-    // 创建顶点缓冲区
-    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-    
-    if (vkCreateBuffer(m_vulkanContext->getDevice(), &bufferInfo, nullptr, &m_vertexBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create vertex buffer!");
-    }
-    
-    vkGetBufferMemoryRequirements(m_vulkanContext->getDevice(), m_vertexBuffer, &memRequirements);
-    
-    // 使用设备本地内存，适合GPU访问
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    
-    if (vkAllocateMemory(m_vulkanContext->getDevice(), &allocInfo, nullptr, &m_vertexBufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate vertex buffer memory!");
-    }
-    
-    vkBindBufferMemory(m_vulkanContext->getDevice(), m_vertexBuffer, m_vertexBufferMemory, 0);
-    
-    // 复制数据到顶点缓冲区
-    VkCommandBuffer commandBuffer;
-    
-    // 简化的命令缓冲区创建（实际项目中应该使用现有的命令池）
-    VkCommandPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    poolInfo.queueFamilyIndex = 0;
-    
-    VkCommandPool commandPool;
-    vkCreateCommandPool(m_vulkanContext->getDevice(), &poolInfo, nullptr, &commandPool);
-    
-    VkCommandBufferAllocateInfo allocInfoCmd{};
-    allocInfoCmd.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfoCmd.commandPool = commandPool;
-    allocInfoCmd.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfoCmd.commandBufferCount = 1;
-    
-    vkAllocateCommandBuffers(m_vulkanContext->getDevice(), &allocInfoCmd, &commandBuffer);
-    
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-    
-    VkBufferCopy copyRegion{};
-    copyRegion.size = bufferSize;
-    vkCmdCopyBuffer(commandBuffer, stagingBuffer, m_vertexBuffer, 1, &copyRegion);
-    
-    vkEndCommandBuffer(commandBuffer);
-    
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-    
-    // 使用图形队列而不是设备
-    vkQueueSubmit(m_vulkanContext->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(m_vulkanContext->getGraphicsQueue());
-    
-    // 清理临时资源
-    vkDestroyBuffer(m_vulkanContext->getDevice(), stagingBuffer, nullptr);
-    vkFreeMemory(m_vulkanContext->getDevice(), stagingBufferMemory, nullptr);
-    vkDestroyCommandPool(m_vulkanContext->getDevice(), commandPool, nullptr);
+    // 创建设备本地缓冲区
+    m_vulkanContext->getAllocator().createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexBuffer, m_vertexBufferMemory,
+                                                 GpuMemoryCategory::Geometry);
+
+    // 通过共享的暂存环形缓冲区上传，随下一帧一起提交
+    m_vulkanContext->getUploadBatcher().upload(m_vertexBuffer, 0, m_vertices.data(), bufferSize);
     
     Logger::debug("Vertex buffer created successfully");
 }
@@ -297,21 +206,6 @@ VkShaderModule CoordinateSystemRenderer::createShaderModule(const std::vector<ch
     return shaderModule;
 }
 
-// 实现findMemoryType方法
-uint32_t CoordinateSystemRenderer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(m_vulkanContext->getPhysicalDevice(), &memProperties);
-    
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && 
-            (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
-    }
-    
-    throw std::runtime_error("Failed to find suitable memory type!");
-}
-
 // 创建着色器模块
 void CoordinateSystemRenderer::createShaderModules() {
     Logger::debug("Creating shader modules...");
@@ -331,18 +225,15 @@ void CoordinateSystemRenderer::createShaderModules() {
 void CoordinateSystemRenderer::createPipelineLayout() {
     Logger::debug("Creating pipeline layout...");
 
-    // Push constant range for MVP matrix
-    VkPushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-    pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(glm::mat4);
+    // The MVP matrix comes from the camera uniform buffer (set 0)
+    VkDescriptorSetLayout cameraSetLayout = m_cameraUniforms->getDescriptorSetLayout();
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pSetLayouts = nullptr;
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &cameraSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 0;
+    pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
     if (vkCreatePipelineLayout(m_vulkanContext->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create pipeline layout!");
@@ -355,139 +246,48 @@ void CoordinateSystemRenderer::createPipelineLayout() {
 void CoordinateSystemRenderer::createGraphicsPipeline() {
     Logger::debug("Creating graphics pipeline...");
     
-    // 着色器阶段
-    VkPipelineShaderStageCreateInfo vertexShaderStageInfo{};
-    vertexShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertexShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertexShaderStageInfo.module = m_vertexShaderModule;
-    vertexShaderStageInfo.pName = "main";
-    
-    VkPipelineShaderStageCreateInfo fragmentShaderStageInfo{};
-    fragmentShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragmentShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragmentShaderStageInfo.module = m_fragmentShaderModule;
-    fragmentShaderStageInfo.pName = "main";
-    
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertexShaderStageInfo, fragmentShaderStageInfo};
-    
-    // 顶点输入状态
-    VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(CoordinateVertex);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    
-    std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
-    
-    // 位置属性
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(CoordinateVertex, position);
-    
-    // 颜色属性
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(CoordinateVertex, color);
-    
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-    
-    // 输入装配状态
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-    
-    // 视口和裁剪矩形（使用默认值）
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.scissorCount = 1;
-    
-    // 光栅化状态
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-    
-    // 多重采样状态
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-    
-    // 深度和模板状态（禁用）
-    VkPipelineDepthStencilStateCreateInfo depthStencil{};
-    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencil.depthTestEnable = VK_FALSE;
-    depthStencil.depthWriteEnable = VK_FALSE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-    depthStencil.depthBoundsTestEnable = VK_FALSE;
-    depthStencil.stencilTestEnable = VK_FALSE;
-    
-    // 颜色混合状态
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-    
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.logicOp = VK_LOGIC_OP_COPY;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
-    colorBlending.blendConstants[0] = 0.0f;
-    colorBlending.blendConstants[1] = 0.0f;
-    colorBlending.blendConstants[2] = 0.0f;
-    colorBlending.blendConstants[3] = 0.0f;
-    
-    // 动态状态（允许动态修改视口和裁剪矩形）
-    std::vector<VkDynamicState> dynamicStates = {
-        VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR
-    };
-    
-    VkPipelineDynamicStateCreateInfo dynamicState{};
-    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-    dynamicState.pDynamicStates = dynamicStates.data();
-    
-    // 创建图形管线
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = &depthStencil;
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = m_pipelineLayout;
-    pipelineInfo.renderPass = m_vulkanContext->getRenderPass();
-    pipelineInfo.subpass = 0;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-    pipelineInfo.basePipelineIndex = -1;
-    
-    if (vkCreateGraphicsPipelines(m_vulkanContext->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create graphics pipeline!");
-    }
+    m_graphicsPipeline = m_vulkanContext->getPipelineBuilder().getPipeline(
+        makePipelineKey(m_vertexShaderModule, m_fragmentShaderModule));
     
     Logger::debug("Graphics pipeline created successfully");
 }
 
+// 管线描述（热重载时用新的着色器模块构建）
+PipelineKey CoordinateSystemRenderer::makePipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader) const {
+    PipelineKey key;
+    key.vertexShader = vertexShader;
+    key.fragmentShader = fragmentShader;
+    key.layout = m_pipelineLayout;
+    key.renderPass = m_vulkanContext->getRenderPass();
+    
+    // 顶点输入：位置和颜色
+    key.bindings.push_back({0, sizeof(CoordinateVertex), VK_VERTEX_INPUT_RATE_VERTEX});
+    key.attributes.push_back({0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(CoordinateVertex, position)});
+    key.attributes.push_back({1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(CoordinateVertex, color)});
+    
+    // 线段列表，禁用深度测试
+    key.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+    key.cullMode = VK_CULL_MODE_BACK_BIT;
+    key.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    key.depthTest = false;
+    key.depthWrite = false;
+    return key;
+}
+
+// 在重载线程上构建新管线
+VkPipeline CoordinateSystemRenderer::buildPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader) {
+    return m_vulkanContext->getPipelineBuilder().getPipeline(makePipelineKey(vertexShader, fragmentShader));
+}
+
+// 在渲染线程上替换着色器，旧模块和管线在帧槽位空闲后销毁
+void CoordinateSystemRenderer::replaceShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkPipeline pipeline) {
+    ShaderHotReloader::retireShaders(m_vulkanContext, m_vertexShaderModule, m_fragmentShaderModule);
+    m_vertexShaderModule = vertexShader;
+    m_fragmentShaderModule = fragmentShader;
+    m_graphicsPipeline = pipeline;
+    m_pipelineVersion++;
+}
+
 // 创建描述符集布局
 void CoordinateSystemRenderer::createDescriptorSetLayout() {
     // 简化实现，暂时不创建描述符集布局
@@ -507,18 +307,13 @@ void CoordinateSystemRenderer::createDescriptorSets() {
 }
 
 // 绘制坐标系
-void CoordinateSystemRenderer::draw(VkCommandBuffer commandBuffer) {
+void CoordinateSystemRenderer::draw(VkCommandBuffer commandBuffer, uint32_t frameSlot) {
     // 绑定管线
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
 
-    // Calculate MVP matrix
-    glm::mat4 model = glm::mat4(1.0f);
-    glm::mat4 view = m_camera->getViewMatrix();
-    glm::mat4 proj = m_camera->getProjectionMatrix();
-    glm::mat4 mvp = proj * view * model;
-
-    // Push MVP matrix
-    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &mvp);
+    // Model matrix is identity; the view-projection is read from the frame slot's uniform buffer
+    VkDescriptorSet cameraSet = m_cameraUniforms->getDescriptorSet(frameSlot);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &cameraSet, 0, nullptr);
 
     // 设置顶点缓冲区
     VkBuffer vertexBuffers[] = {m_vertexBuffer};
@@ -548,44 +343,39 @@ void CoordinateSystemRenderer::draw(VkCommandBuffer commandBuffer) {
 void CoordinateSystemRenderer::cleanup() {
     Logger::debug("Cleaning up coordinate system renderer resources...");
     
-    if (m_graphicsPipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(m_vulkanContext->getDevice(), m_graphicsPipeline, nullptr);
+    // 管线归管线构建器所有，随着色器模块一起释放
+    if (m_vertexShaderModule != VK_NULL_HANDLE) {
+        m_vulkanContext->getPipelineBuilder().destroyPipelines(m_vertexShaderModule);
     }
+    m_graphicsPipeline = VK_NULL_HANDLE;
     
     if (m_pipelineLayout != VK_NULL_HANDLE) {
         vkDestroyPipelineLayout(m_vulkanContext->getDevice(), m_pipelineLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
     }
     
     if (m_fragmentShaderModule != VK_NULL_HANDLE) {
         vkDestroyShaderModule(m_vulkanContext->getDevice(), m_fragmentShaderModule, nullptr);
+        m_fragmentShaderModule = VK_NULL_HANDLE;
     }
     
     if (m_vertexShaderModule != VK_NULL_HANDLE) {
         vkDestroyShaderModule(m_vulkanContext->getDevice(), m_vertexShaderModule, nullptr);
+        m_vertexShaderModule = VK_NULL_HANDLE;
     }
     
-    if (m_indexBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(m_vulkanContext->getDevice(), m_indexBuffer, nullptr);
-    }
-    
-    if (m_indexBufferMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(m_vulkanContext->getDevice(), m_indexBufferMemory, nullptr);
-    }
-    
-    if (m_vertexBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(m_vulkanContext->getDevice(), m_vertexBuffer, nullptr);
-    }
+    m_vulkanContext->getAllocator().destroyBuffer(m_indexBuffer, m_indexBufferMemory);
     
-    if (m_vertexBufferMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(m_vulkanContext->getDevice(), m_vertexBufferMemory, nullptr);
-    }
+    m_vulkanContext->getAllocator().destroyBuffer(m_vertexBuffer, m_vertexBufferMemory);
     
     if (m_descriptorSetLayout != VK_NULL_HANDLE) {
         vkDestroyDescriptorSetLayout(m_vulkanContext->getDevice(), m_descriptorSetLayout, nullptr);
+        m_descriptorSetLayout = VK_NULL_HANDLE;
     }
     
     if (m_descriptorPool != VK_NULL_HANDLE) {
         vkDestroyDescriptorPool(m_vulkanContext->getDevice(), m_descriptorPool, nullptr);
+        m_descriptorPool = VK_NULL_HANDLE;
     }
     
     Logger::debug("Coordinate system renderer resources cleaned up");
@@ -3,9 +3,13 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <glm/glm.hpp>
+#include "GpuAllocator.h"
+#include "PipelineBuilder.h"
+#include "ShaderHotReloader.h"
 
 class VulkanContext;
 class Camera;
+class CameraUniforms;
 
 // 顶点数据结构
 struct CoordinateVertex {
@@ -13,15 +17,24 @@ struct CoordinateVertex {
     glm::vec3 color;
 };
 
-class CoordinateSystemRenderer {
+class CoordinateSystemRenderer : public ShaderReloadTarget {
 public:
-    CoordinateSystemRenderer(VulkanContext* vulkanContext, Camera* camera);
-    ~CoordinateSystemRenderer();
+    CoordinateSystemRenderer(VulkanContext* vulkanContext, Camera* camera, CameraUniforms* cameraUniforms);
+    ~CoordinateSystemRenderer() override;
 
     bool init();
-    void draw(VkCommandBuffer commandBuffer);
+    // The camera is read from the frame slot's uniform buffer, so the recorded
+    // commands do not depend on the camera and can be reused
+    void draw(VkCommandBuffer commandBuffer, uint32_t frameSlot);
     void cleanup();
 
+    // 着色器重载后递增，缓存的命令需要重新录制
+    uint64_t getPipelineVersion() const { return m_pipelineVersion; }
+
+    // ShaderReloadTarget
+    VkPipeline buildPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader) override;
+    void replaceShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkPipeline pipeline) override;
+
 private:
     // 初始化方法
     void generateVertexData();
@@ -30,17 +43,18 @@ private:
     void createShaderModules();
     void createPipelineLayout();
     void createGraphicsPipeline();
+    PipelineKey makePipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader) const;
     void createDescriptorSetLayout();
     void createDescriptorPool();
     void createDescriptorSets();
     
     // 辅助方法
     VkShaderModule createShaderModule(const std::vector<char>& code);
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     
     // 成员变量
     VulkanContext* m_vulkanContext;
     Camera* m_camera;
+    CameraUniforms* m_cameraUniforms;
     
     // 顶点数据
     std::vector<CoordinateVertex> m_vertices;
@@ -48,9 +62,9 @@ private:
     
     // Vulkan资源
     VkBuffer m_vertexBuffer;
-    VkDeviceMemory m_vertexBufferMemory;
+    GpuAllocation m_vertexBufferMemory;
     VkBuffer m_indexBuffer;
-    VkDeviceMemory m_indexBufferMemory;
+    GpuAllocation m_indexBufferMemory;
     
     // 着色器
     VkShaderModule m_vertexShaderModule;
@@ -59,16 +73,13 @@ private:
     // 管线
     VkPipelineLayout m_pipelineLayout;
     VkPipeline m_graphicsPipeline;
+    uint64_t m_pipelineVersion = 0;
     
     // 描述符
     VkDescriptorSetLayout m_descriptorSetLayout;
     VkDescriptorPool m_descriptorPool;
     VkDescriptorSet m_descriptorSet;
     
-    // 统一缓冲区（用于MVP矩阵）
-    VkBuffer m_uniformBuffer;
-    VkDeviceMemory m_uniformBufferMemory;
-    
     // 常量
     const float m_axisLength = 100.0f;
     const int m_tickCount = 10;
@@ -3,9 +3,13 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <glm/glm.hpp>
+#include "GpuAllocator.h"
+#include "PipelineBuilder.h"
+#include "ShaderHotReloader.h"
 
 class VulkanContext;
 class Camera;
+class CameraUniforms;
 
 // 顶点数据结构
 struct DemoVertex {
@@ -14,15 +18,27 @@ struct DemoVertex {
     glm::vec3 normal;
 };
 
-class DemoObjectRenderer {
+class DemoObjectRenderer : public ShaderReloadTarget {
 public:
-    DemoObjectRenderer(VulkanContext* vulkanContext, Camera* camera);
-    ~DemoObjectRenderer();
+    DemoObjectRenderer(VulkanContext* vulkanContext, Camera* camera, CameraUniforms* cameraUniforms);
+    ~DemoObjectRenderer() override;
 
     bool init();
-    void draw(VkCommandBuffer commandBuffer);
+    // The camera is read from the frame slot's uniform buffer, so the recorded
+    // commands do not depend on the camera and can be reused
+    void draw(VkCommandBuffer commandBuffer, uint32_t frameSlot);
     void cleanup();
 
+    // 线框显示（设备不支持fillModeNonSolid时忽略）
+    void setWireframe(bool wireframe);
+    bool isWireframe() const { return m_wireframe; }
+    // 管线更换（线框切换或着色器重载）后递增，缓存的命令需要重新录制
+    uint64_t getPipelineVersion() const { return m_pipelineVersion; }
+
+    // ShaderReloadTarget
+    VkPipeline buildPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader) override;
+    void replaceShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkPipeline pipeline) override;
+
 private:
     // 初始化方法
     void generateVertexData();
@@ -31,17 +47,18 @@ private:
     void createShaderModules();
     void createPipelineLayout();
     void createGraphicsPipeline();
+    PipelineKey makePipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader, bool wireframe) const;
     void createDescriptorSetLayout();
     void createDescriptorPool();
     void createDescriptorSets();
     
     // 辅助方法
     VkShaderModule createShaderModule(const std::vector<char>& code);
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     
     // 成员变量
     VulkanContext* m_vulkanContext;
     Camera* m_camera;
+    CameraUniforms* m_cameraUniforms;
     
     // 顶点数据
     std::vector<DemoVertex> m_vertices;
@@ -49,9 +66,9 @@ private:
     
     // Vulkan资源
     VkBuffer m_vertexBuffer;
-    VkDeviceMemory m_vertexBufferMemory;
+    GpuAllocation m_vertexBufferMemory;
     VkBuffer m_indexBuffer;
-    VkDeviceMemory m_indexBufferMemory;
+    GpuAllocation m_indexBufferMemory;
     
     // 着色器
     VkShaderModule m_vertexShaderModule;
@@ -60,13 +77,11 @@ private:
     // 管线
     VkPipelineLayout m_pipelineLayout;
     VkPipeline m_graphicsPipeline;
+    bool m_wireframe;
+    uint64_t m_pipelineVersion = 0;
     
     // 描述符
     VkDescriptorSetLayout m_descriptorSetLayout;
     VkDescriptorPool m_descriptorPool;
     VkDescriptorSet m_descriptorSet;
-    
-    // 统一缓冲区（用于MVP矩阵）
-    VkBuffer m_uniformBuffer;
-    VkDeviceMemory m_uniformBufferMemory;
 };
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "FrameReadback.h"
+#include "VulkanContext.h"
+#include "Logger.h"
+#include <algorithm>
+#include <stdexcept>
+
+FrameReadback::FrameReadback(VulkanContext* vulkanContext)
+    : m_vulkanContext(vulkanContext), m_extent{0, 0},
+      m_requested(false), m_requestedTag(0), m_nextSequence(0) {
+}
+
+FrameReadback::~FrameReadback() {
+    cleanup();
+}
+
+bool FrameReadback::init() {
+    if (!m_vulkanContext->isHeadless()) {
+        Logger::error("Frame readback requires headless mode!");
+        return false;
+    }
+
+    try {
+        m_extent = m_vulkanContext->getSwapchainExtent();
+        VkDeviceSize size = static_cast<VkDeviceSize>(m_extent.width) * m_extent.height * 4;
+
+        // One buffer per frame in flight
+        m_slots.resize(m_vulkanContext->getFrameCount());
+        for (Slot& slot : m_slots) {
+            m_vulkanContext->getAllocator().createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, slot.buffer, slot.memory,
+                GpuMemoryCategory::Staging);
+            slot.mapped = slot.memory.mapped;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        Logger::error("FrameReadback initialization error: {}", e.what());
+        cleanup();
+        return false;
+    }
+}
+
+void FrameReadback::cleanup() {
+    for (Slot& slot : m_slots) {
+        m_vulkanContext->getAllocator().destroyBuffer(slot.buffer, slot.memory);
+    }
+    m_slots.clear();
+    m_requested = false;
+}
+
+void FrameReadback::request(uint64_t tag) {
+    m_requested = true;
+    m_requestedTag = tag;
+}
+
+void FrameReadback::collect(uint32_t slot) {
+    if (slot >= m_slots.size() || !m_slots[slot].pending) {
+        return;
+    }
+
+    Slot& current = m_slots[slot];
+    current.pending = false;
+    if (m_callback) {
+        m_callback(current.tag, static_cast<const uint8_t*>(current.mapped), m_extent.width, m_extent.height);
+    }
+}
+
+void FrameReadback::record(VkCommandBuffer commandBuffer, VkImage image, uint32_t slot) {
+    if (!m_requested || slot >= m_slots.size()) {
+        return;
+    }
+
+    Slot& current = m_slots[slot];
+    VkBufferImageCopy region{};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = { m_extent.width, m_extent.height, 1 };
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, current.buffer, 1, &region);
+
+    current.pending = true;
+    current.tag = m_requestedTag;
+    current.sequence = m_nextSequence++;
+    m_requested = false;
+}
+
+void FrameReadback::flush() {
+    vkDeviceWaitIdle(m_vulkanContext->getDevice());
+
+    std::vector<uint32_t> pendingSlots;
+    for (uint32_t i = 0; i < m_slots.size(); i++) {
+        if (m_slots[i].pending) {
+            pendingSlots.push_back(i);
+        }
+    }
+    std::sort(pendingSlots.begin(), pendingSlots.end(), [this](uint32_t a, uint32_t b) {
+        return m_slots[a].sequence < m_slots[b].sequence;
+    });
+    for (uint32_t slot : pendingSlots) {
+        collect(slot);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "GpuAllocator.h"
+
+class VulkanContext;
+
+// Pipelined readback of rendered offscreen frames (headless mode). A requested
+// frame is copied into a host-visible buffer of its frame-in-flight slot as
+// part of the frame's command buffer; the pixels are handed to the callback
+// once the slot's fence has been waited on, so the CPU never stalls on the
+// copy of the frame it just submitted.
+class FrameReadback {
+public:
+    // Called with tightly packed RGBA8 pixels; the pointer is only valid during the call
+    using Callback = std::function<void(uint64_t tag, const uint8_t* rgba, uint32_t width, uint32_t height)>;
+
+    explicit FrameReadback(VulkanContext* vulkanContext);
+    ~FrameReadback();
+
+    bool init();
+    void cleanup();
+
+    void setCallback(Callback callback) { m_callback = std::move(callback); }
+
+    // Capture the next rendered frame and report it with 'tag'
+    void request(uint64_t tag);
+
+    // Deliver the capture of 'slot' if there is one; the slot's fence must be signaled
+    void collect(uint32_t slot);
+    // Whether the next rendered frame should be captured
+    bool isRequested() const { return m_requested; }
+    // Readback buffer of a frame-in-flight slot
+    VkBuffer getBuffer(uint32_t slot) const { return slot < m_slots.size() ? m_slots[slot].buffer : VK_NULL_HANDLE; }
+    // Record the copy of 'image' for a pending request into the slot's buffer.
+    // The image must be in TRANSFER_SRC layout with the render pass writes
+    // visible; making the copy visible to the host is left to the caller
+    void record(VkCommandBuffer commandBuffer, VkImage image, uint32_t slot);
+    // Wait for the device and deliver all outstanding captures in submission order
+    void flush();
+
+private:
+    struct Slot {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        GpuAllocation memory;
+        void* mapped = nullptr;
+        bool pending = false;
+        uint64_t tag = 0;
+        uint64_t sequence = 0;
+    };
+
+    VulkanContext* m_vulkanContext;
+    std::vector<Slot> m_slots;
+    Callback m_callback;
+    VkExtent2D m_extent;
+    bool m_requested;
+    uint64_t m_requestedTag;
+    uint64_t m_nextSequence;
+};
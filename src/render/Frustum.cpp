@@ -0,0 +1,100 @@
+#include "Frustum.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define FRUSTUM_USE_SSE 1
+#endif
+
+void AabbArray::resize(size_t boxCount) {
+    count = boxCount;
+    size_t padded = (boxCount + 3) & ~size_t(3);
+    minX.assign(padded, 0.0f);
+    minY.assign(padded, 0.0f);
+    minZ.assign(padded, 0.0f);
+    maxX.assign(padded, 0.0f);
+    maxY.assign(padded, 0.0f);
+    maxZ.assign(padded, 0.0f);
+}
+
+void AabbArray::set(size_t index, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    minX[index] = boundsMin.x;
+    minY[index] = boundsMin.y;
+    minZ[index] = boundsMin.z;
+    maxX[index] = boundsMax.x;
+    maxY[index] = boundsMax.y;
+    maxZ[index] = boundsMax.z;
+}
+
+Frustum Frustum::fromViewProjection(const glm::mat4& m) {
+    // Rows of the matrix (glm is column-major)
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum;
+    frustum.planes[0] = row3 + row0;    // left
+    frustum.planes[1] = row3 - row0;    // right
+    frustum.planes[2] = row3 + row1;    // bottom
+    frustum.planes[3] = row3 - row1;    // top
+    frustum.planes[4] = row2;           // near
+    frustum.planes[5] = row3 - row2;    // far
+    return frustum;
+}
+
+bool Frustum::intersects(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+    for (const glm::vec4& plane : planes) {
+        // Corner furthest along the plane normal
+        glm::vec3 p(plane.x >= 0.0f ? boundsMax.x : boundsMin.x,
+                    plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+                    plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+        if (plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t Frustum::cull(const AabbArray& boxes, uint8_t* visible) const {
+    size_t visibleCount = 0;
+
+#ifdef FRUSTUM_USE_SSE
+    // Four boxes per iteration; the arrays are padded so the last group is safe to load
+    for (size_t i = 0; i < boxes.count; i += 4) {
+        __m128 minX = _mm_loadu_ps(&boxes.minX[i]);
+        __m128 minY = _mm_loadu_ps(&boxes.minY[i]);
+        __m128 minZ = _mm_loadu_ps(&boxes.minZ[i]);
+        __m128 maxX = _mm_loadu_ps(&boxes.maxX[i]);
+        __m128 maxY = _mm_loadu_ps(&boxes.maxY[i]);
+        __m128 maxZ = _mm_loadu_ps(&boxes.maxZ[i]);
+
+        __m128 outside = _mm_setzero_ps();
+        for (const glm::vec4& plane : planes) {
+            __m128 px = plane.x >= 0.0f ? maxX : minX;
+            __m128 py = plane.y >= 0.0f ? maxY : minY;
+            __m128 pz = plane.z >= 0.0f ? maxZ : minZ;
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(plane.x)), _mm_mul_ps(py, _mm_set1_ps(plane.y))),
+                _mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+        }
+
+        int outsideMask = _mm_movemask_ps(outside);
+        size_t groupCount = (boxes.count - i) < 4 ? (boxes.count - i) : 4;
+        for (size_t lane = 0; lane < groupCount; lane++) {
+            uint8_t isVisible = (outsideMask & (1 << lane)) ? 0 : 1;
+            visible[i + lane] = isVisible;
+            visibleCount += isVisible;
+        }
+    }
+#else
+    for (size_t i = 0; i < boxes.count; i++) {
+        glm::vec3 boundsMin(boxes.minX[i], boxes.minY[i], boxes.minZ[i]);
+        glm::vec3 boundsMax(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]);
+        visible[i] = intersects(boundsMin, boundsMax) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+#endif
+
+    return visibleCount;
+}
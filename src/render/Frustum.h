@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Axis-aligned boxes stored as separate coordinate arrays so that several boxes
+// can be tested against a plane at once. Arrays are padded to a multiple of 4.
+struct AabbArray {
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+    size_t count = 0;
+
+    void resize(size_t boxCount);
+    void set(size_t index, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+    void clear() { resize(0); }
+};
+
+// View frustum as 6 planes (xyz = normal pointing inside, w = distance),
+// extracted from a view-projection matrix using the Vulkan clip volume
+// (-w <= x, y <= w, 0 <= z <= w).
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum fromViewProjection(const glm::mat4& viewProjection);
+
+    bool intersects(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+    // Test all boxes; visible[i] is set to 1 if box i intersects the frustum,
+    // 0 otherwise. Returns the number of visible boxes.
+    size_t cull(const AabbArray& boxes, uint8_t* visible) const;
+};
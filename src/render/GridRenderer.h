@@ -4,9 +4,13 @@
 #include <vector>
 #include <string>
 #include <glm/glm.hpp>
+#include "GpuAllocator.h"
+#include "PipelineBuilder.h"
+#include "ShaderHotReloader.h"
 
 class VulkanContext;
 class Camera;
+class CameraUniforms;
 
 // Grid vertex structure
 struct GridVertex {
@@ -24,16 +28,28 @@ struct GridLabel {
         : worldPos(pos), text(txt), color(col) {}
 };
 
-class GridRenderer {
+class GridRenderer : public ShaderReloadTarget {
 public:
-    GridRenderer(VulkanContext* vulkanContext, Camera* camera);
-    ~GridRenderer();
+    GridRenderer(VulkanContext* vulkanContext, Camera* camera, CameraUniforms* cameraUniforms);
+    ~GridRenderer() override;
 
     bool init();
-    void draw(VkCommandBuffer commandBuffer);
+    // The camera is read from the frame slot's uniform buffer, so the recorded
+    // commands do not depend on the camera and can be reused
+    void draw(VkCommandBuffer commandBuffer, uint32_t frameSlot);
     void drawLabels();  // Call after ImGui::NewFrame, before ImGui::Render
+    // Apply pending settings changes; call before recording draw()
+    void update();
+    // Incremented whenever the geometry is rebuilt; recorded draws must be re-recorded
+    uint64_t getGeometryVersion() const { return m_geometryVersion; }
+    // Incremented whenever the shaders are reloaded
+    uint64_t getPipelineVersion() const { return m_pipelineVersion; }
     void cleanup();
 
+    // ShaderReloadTarget
+    VkPipeline buildPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader) override;
+    void replaceShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkPipeline pipeline) override;
+
     // Settings
     void setGridSize(float size) { m_gridSize = size; m_needsRebuild = true; }
     void setGridSpacing(float spacing) { m_gridSpacing = spacing; m_needsRebuild = true; }
@@ -50,13 +66,13 @@ private:
     void createShaderModules();
     void createPipelineLayout();
     void createGraphicsPipeline();
+    PipelineKey makePipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader) const;
     void rebuildIfNeeded();
     glm::vec2 worldToScreen(const glm::vec3& worldPos);
 
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
-
     VulkanContext* m_vulkanContext;
     Camera* m_camera;
+    CameraUniforms* m_cameraUniforms;
 
     // Vertex data
     std::vector<GridVertex> m_vertices;
@@ -66,7 +82,7 @@ private:
 
     // Vulkan resources
     VkBuffer m_vertexBuffer;
-    VkDeviceMemory m_vertexBufferMemory;
+    GpuAllocation m_vertexBufferMemory;
 
     // Shaders
     VkShaderModule m_vertexShaderModule;
@@ -81,5 +97,7 @@ private:
     float m_gridSpacing = 1.0f;
     bool m_showLabels = true;
     bool m_needsRebuild = false;
+    uint64_t m_geometryVersion = 0;
+    uint64_t m_pipelineVersion = 0;
 };
 
@@ -0,0 +1,206 @@
+#include "ParallelRecorder.h"
+#include "VulkanContext.h"
+#include "ThreadPool.h"
+#include "Config.h"
+#include "Logger.h"
+#include <atomic>
+#include <stdexcept>
+
+ParallelRecorder::ParallelRecorder(VulkanContext* vulkanContext)
+    : m_vulkanContext(vulkanContext), m_frameSlot(0), m_framebuffer(VK_NULL_HANDLE), m_usedPassSlots(0) {}
+
+ParallelRecorder::~ParallelRecorder() {
+    cleanup();
+}
+
+bool ParallelRecorder::init() {
+    Config& config = Config::getInstance();
+    m_passSlots.resize(m_vulkanContext->getFrameCount());
+    m_staticSlots.resize(m_vulkanContext->getFrameCount());
+
+    if (!config.getBool("parallel_recording", true)) {
+        Logger::info("Parallel command recording disabled");
+        return true;
+    }
+
+    int threads = config.getInt("render_threads", 0);
+    m_threadPool = std::make_unique<ThreadPool>(threads > 0 ? static_cast<size_t>(threads) : 0);
+
+    Logger::info("Parallel command recording with {} worker threads", m_threadPool->getThreadCount());
+    return true;
+}
+
+void ParallelRecorder::cleanup() {
+    m_threadPool.reset();
+
+    if (m_passSlots.empty()) {
+        return;
+    }
+    VkDevice device = m_vulkanContext->getDevice();
+    vkDeviceWaitIdle(device);
+    // Destroying a pool frees its command buffers
+    for (auto& frameSlots : m_passSlots) {
+        for (auto& slot : frameSlots) {
+            vkDestroyCommandPool(device, slot.commandPool, nullptr);
+        }
+    }
+    for (auto& frameSlots : m_staticSlots) {
+        for (auto& slot : frameSlots) {
+            if (slot.pass.commandPool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(device, slot.pass.commandPool, nullptr);
+            }
+        }
+    }
+    m_passSlots.clear();
+    m_staticSlots.clear();
+}
+
+void ParallelRecorder::beginFrame(uint32_t frameSlot, VkFramebuffer framebuffer) {
+    m_frameSlot = frameSlot;
+    m_framebuffer = framebuffer;
+    m_usedPassSlots = 0;
+}
+
+void ParallelRecorder::ensurePassSlots(size_t count) {
+    std::vector<PassSlot>& slots = m_passSlots[m_frameSlot];
+    while (slots.size() < count) {
+        PassSlot slot;
+        createPassSlot(slot);
+        slots.push_back(slot);
+    }
+}
+
+void ParallelRecorder::createPassSlot(PassSlot& slot) {
+    VkDevice device = m_vulkanContext->getDevice();
+
+    // Transient: the buffers are re-recorded every time the slot comes around
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = m_vulkanContext->getGraphicsQueueFamily();
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &slot.commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create secondary command pool!");
+    }
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = slot.commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(device, &allocInfo, &slot.commandBuffer) != VK_SUCCESS) {
+        vkDestroyCommandPool(device, slot.commandPool, nullptr);
+        slot.commandPool = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to allocate secondary command buffer!");
+    }
+}
+
+VkCommandBuffer ParallelRecorder::beginSecondary(PassSlot& slot, VkFramebuffer framebuffer,
+                                                 VkCommandBufferUsageFlags flags) {
+    // The slot's fence has been waited on, so nothing recorded from this pool is pending
+    vkResetCommandPool(m_vulkanContext->getDevice(), slot.commandPool, 0);
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = m_vulkanContext->getRenderPass();
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = framebuffer;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | flags;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (vkBeginCommandBuffer(slot.commandBuffer, &beginInfo) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+    return slot.commandBuffer;
+}
+
+void ParallelRecorder::execute(VkCommandBuffer primary, const std::vector<RecordFunction>& passes) {
+    if (passes.empty()) {
+        return;
+    }
+    size_t firstSlot = m_usedPassSlots;
+    ensurePassSlots(firstSlot + passes.size());
+    m_usedPassSlots += passes.size();
+    std::vector<PassSlot>& slots = m_passSlots[m_frameSlot];
+
+    std::atomic<bool> failed(false);
+    auto recordPass = [this, &slots, &passes, &failed, firstSlot](size_t index) {
+        VkCommandBuffer commandBuffer = beginSecondary(slots[firstSlot + index], m_framebuffer,
+                                                       VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        if (commandBuffer == VK_NULL_HANDLE) {
+            failed = true;
+            return;
+        }
+        passes[index](commandBuffer);
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            failed = true;
+        }
+    };
+
+    if (m_threadPool) {
+        // Workers take the remaining passes while this thread records the first one
+        for (size_t i = 1; i < passes.size(); i++) {
+            m_threadPool->submit([&recordPass, i]() { recordPass(i); });
+        }
+        try {
+            recordPass(0);
+        } catch (...) {
+            // The workers still reference this frame's state
+            m_threadPool->wait();
+            throw;
+        }
+        m_threadPool->wait();
+    } else {
+        for (size_t i = 0; i < passes.size(); i++) {
+            recordPass(i);
+        }
+    }
+
+    if (failed) {
+        throw std::runtime_error("Failed to record secondary command buffers!");
+    }
+
+    std::vector<VkCommandBuffer> commandBuffers(passes.size());
+    for (size_t i = 0; i < passes.size(); i++) {
+        commandBuffers[i] = slots[firstSlot + i].commandBuffer;
+    }
+    vkCmdExecuteCommands(primary, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+}
+
+void ParallelRecorder::executeStatic(VkCommandBuffer primary, uint32_t layer, uint64_t version,
+                                     const RecordFunction& record) {
+    std::vector<StaticSlot>& slots = m_staticSlots[m_frameSlot];
+    if (slots.size() <= layer) {
+        slots.resize(layer + 1);
+    }
+    StaticSlot& slot = slots[layer];
+    if (slot.pass.commandPool == VK_NULL_HANDLE) {
+        createPassSlot(slot.pass);
+    }
+
+    VkRenderPass renderPass = m_vulkanContext->getRenderPass();
+    VkExtent2D extent = m_vulkanContext->getSwapchainExtent();
+    bool upToDate = slot.recorded && slot.version == version && slot.renderPass == renderPass &&
+                    slot.extent.width == extent.width && slot.extent.height == extent.height;
+    if (!upToDate) {
+        // Not bound to a framebuffer, so the same buffer works for every swapchain image
+        slot.recorded = false;
+        VkCommandBuffer commandBuffer = beginSecondary(slot.pass, VK_NULL_HANDLE, 0);
+        if (commandBuffer == VK_NULL_HANDLE) {
+            throw std::runtime_error("Failed to begin static secondary command buffer!");
+        }
+        record(commandBuffer);
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record static secondary command buffer!");
+        }
+        slot.recorded = true;
+        slot.version = version;
+        slot.renderPass = renderPass;
+        slot.extent = extent;
+        Logger::debug("Recorded static layer {} for frame slot {}", layer, m_frameSlot);
+    }
+
+    vkCmdExecuteCommands(primary, 1, &slot.pass.commandBuffer);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class VulkanContext;
+class ThreadPool;
+
+// Records the draws of one render pass into secondary command buffers on
+// worker threads. Every pass gets its own command pool per frame-in-flight
+// slot, so no pool is ever used by two threads at once and a slot's pools can
+// be reset wholesale once its fence has been waited on.
+//
+// Layers whose commands do not change between frames can instead be recorded
+// once per slot with executeStatic() and are only re-recorded when their
+// version, the render pass or the swapchain extent changes.
+class ParallelRecorder {
+public:
+    using RecordFunction = std::function<void(VkCommandBuffer commandBuffer)>;
+
+    explicit ParallelRecorder(VulkanContext* vulkanContext);
+    ~ParallelRecorder();
+
+    bool init();
+    void cleanup();
+
+    // False when parallel recording is disabled (config parallel_recording);
+    // execute() then records the passes one after another on the calling thread
+    bool isParallel() const { return m_threadPool != nullptr; }
+
+    // Start recording the render pass of a frame-in-flight slot whose fence
+    // has been waited on; recycles the slot's secondary command buffers
+    void beginFrame(uint32_t frameSlot, VkFramebuffer framebuffer);
+
+    // Record every function into its own secondary command buffer in parallel
+    // and execute them in order. The render pass must have been begun with
+    // VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS on 'primary'. May be called
+    // several times per frame; later calls are executed after earlier ones.
+    void execute(VkCommandBuffer primary, const std::vector<RecordFunction>& passes);
+
+    // Execute the cached secondary command buffer of 'layer' for the current
+    // frame slot, recording it first if it is missing or out of date. The
+    // recorded commands may only depend on the frame slot (e.g. its descriptor
+    // sets), the render pass and the extent, not on per-frame values.
+    void executeStatic(VkCommandBuffer primary, uint32_t layer, uint64_t version, const RecordFunction& record);
+
+private:
+    struct PassSlot {
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    };
+
+    struct StaticSlot {
+        PassSlot pass;
+        bool recorded = false;
+        uint64_t version = 0;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        VkExtent2D extent = { 0, 0 };
+    };
+
+    void ensurePassSlots(size_t count);
+    void createPassSlot(PassSlot& slot);
+    VkCommandBuffer beginSecondary(PassSlot& slot, VkFramebuffer framebuffer, VkCommandBufferUsageFlags flags);
+
+    VulkanContext* m_vulkanContext;
+    std::unique_ptr<ThreadPool> m_threadPool;
+    // [frame slot][pass]
+    std::vector<std::vector<PassSlot>> m_passSlots;
+    // [frame slot][layer]
+    std::vector<std::vector<StaticSlot>> m_staticSlots;
+    uint32_t m_frameSlot;
+    VkFramebuffer m_framebuffer;
+    size_t m_usedPassSlots;
+};
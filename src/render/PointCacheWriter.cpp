@@ -0,0 +1,74 @@
+#include "PointCacheWriter.h"
+#include "PluginContext.h"
+#include "PointOctree.h"
+#include "Logger.h"
+
+bool PointCacheWriter::write(const std::string& filename, const std::vector<PluginPointData>& points,
+                             uint32_t chunkSize) {
+    if (chunkSize == 0) {
+        chunkSize = PointCache::DEFAULT_CHUNK_SIZE;
+    }
+
+    // Build the LOD hierarchy; its nodes become the cache chunks
+    const size_t pointCount = points.size();
+    std::vector<float> positions(pointCount * 3);
+    for (size_t i = 0; i < pointCount; i++) {
+        positions[i * 3 + 0] = points[i].x;
+        positions[i * 3 + 1] = points[i].y;
+        positions[i * 3 + 2] = points[i].z;
+    }
+
+    PointOctree octree;
+    octree.build(positions.data(), pointCount, chunkSize);
+    const std::vector<PointOctreeNode>& nodes = octree.getNodes();
+    const std::vector<uint32_t>& order = octree.getOrder();
+
+    std::vector<PointCacheChunk> chunks(nodes.size());
+    for (size_t c = 0; c < nodes.size(); c++) {
+        const PointOctreeNode& node = nodes[c];
+        PointCacheChunk& chunk = chunks[c];
+        for (int axis = 0; axis < 3; axis++) {
+            chunk.boundsMin[axis] = node.boundsMin[axis];
+            chunk.boundsMax[axis] = node.boundsMax[axis];
+        }
+        chunk.firstPoint = node.firstPoint;
+        chunk.pointCount = node.pointCount;
+        chunk.firstChild = node.firstChild;
+        chunk.childCount = node.childCount;
+    }
+
+    // Columns in hierarchy order
+    std::vector<float> colors(pointCount * 3);
+    std::vector<float> sizes(pointCount);
+    for (size_t i = 0; i < pointCount; i++) {
+        const auto& p = points[order[i]];
+        positions[i * 3 + 0] = p.x;
+        positions[i * 3 + 1] = p.y;
+        positions[i * 3 + 2] = p.z;
+        colors[i * 3 + 0] = p.r;
+        colors[i * 3 + 1] = p.g;
+        colors[i * 3 + 2] = p.b;
+        sizes[i] = p.size;
+    }
+
+    return PointCache::write(filename, chunks, positions, colors, sizes, chunkSize);
+}
+
+bool PointCacheWriter::save(const std::string& filename, const PluginContext& pluginContext) {
+    const std::shared_ptr<PointCache>& cache = pluginContext.getPointCache();
+    if (!cache) {
+        return write(filename, pluginContext.getPointCloudData());
+    }
+
+    // Rewriting the file that is currently mapped would pull the data out from under us
+    if (filename == cache->getFilename()) {
+        Logger::info("Point cache is already stored in {}", filename);
+        return true;
+    }
+
+    std::vector<PluginPointData> points(pluginContext.getPointCount());
+    for (size_t i = 0; i < points.size(); i++) {
+        points[i] = pluginContext.getPoint(i);
+    }
+    return write(filename, points);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PointCache.h"
+
+struct PluginPointData;
+class PluginContext;
+
+// Writes point cache files: builds the LOD hierarchy of the points and stores
+// the points in its node order, so loading the cache needs no rebuild.
+// PointCache itself only knows the file format.
+class PointCacheWriter {
+public:
+    static bool write(const std::string& filename, const std::vector<PluginPointData>& points,
+                      uint32_t chunkSize = PointCache::DEFAULT_CHUNK_SIZE);
+
+    // Save the active point set of 'pluginContext', whether it came from a
+    // plugin or a point cache
+    static bool save(const std::string& filename, const PluginContext& pluginContext);
+};
@@ -4,15 +4,104 @@
 #include "PluginContext.h"
 #include "Logger.h"
 #include "ShaderCompiler.h"
+#include "PointCache.h"
+#include "Config.h"
 #include <stdexcept>
 #include <array>
+#include <cstring>
+#include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 
+namespace {
+
+// Node layout of the culling shader's storage buffer (std430)
+struct GpuCullNode {
+    float boundsMin[4];
+    float boundsMax[4];
+    uint32_t firstPoint;
+    uint32_t pointCount;
+    uint32_t parent;    // Index in the level-ordered node buffer
+    uint32_t pad;
+};
+constexpr uint32_t CULL_NO_PARENT = UINT32_MAX;
+
+// Push constants of pointcull.comp
+struct GpuCullPushConstants {
+    glm::vec4 planes[6];
+    // 4th row of the view-projection matrix scaled by the screen-size threshold
+    // in world units at w = 1, which keeps the block within the 128 bytes
+    // every device supports
+    glm::vec4 minRadiusW;
+    uint32_t levelFirst;
+    uint32_t levelCount;
+    uint32_t frameSlot;
+    uint32_t pointBudget;
+};
+static_assert(sizeof(GpuCullPushConstants) <= 128, "pointcull.comp push constants exceed the guaranteed limit");
+
+// Draw buffer layout: uvec2 counters[CULL_FRAME_SLOTS], then the draw commands,
+// then the per-node emitted flags at m_cullEmittedOffset.
+// One counter slot per frame in flight; pointcull.comp declares counters[4].
+constexpr uint32_t CULL_FRAME_SLOTS = VulkanContext::MAX_FRAMES_IN_FLIGHT;
+static_assert(CULL_FRAME_SLOTS == 4, "pointcull.comp counter array size must match MAX_FRAMES_IN_FLIGHT");
+constexpr VkDeviceSize CULL_COUNTERS_SIZE = sizeof(uint32_t) * 2 * CULL_FRAME_SLOTS;
+constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+
+// Bytes per point of each column (PointColumn order)
+constexpr VkDeviceSize POINT_COLUMN_STRIDES[POINT_COLUMN_COUNT] = {
+    sizeof(float) * 3,
+    sizeof(float) * 3,
+    sizeof(float),
+    sizeof(uint32_t)
+};
+
+// Push constants of pointsprite.vert; pointpull.vert only reads mvp
+struct ColumnPushConstants {
+    glm::mat4 mvp;
+    glm::vec2 viewportSize;
+};
+
+// Blending and depth state of a point shape
+void applyPointShape(PipelineKey& key, PointShape shape) {
+    key.fragmentConstants = {static_cast<uint32_t>(shape)};
+    if (shape == PointShape::Smooth || shape == PointShape::Gaussian) {
+        key.blendMode = PipelineBlendMode::Alpha;
+    }
+    // Splats overlap, so they must not hide each other
+    if (shape == PointShape::Gaussian) {
+        key.depthWrite = false;
+    }
+}
+
+} // namespace
+
 PointCloudRenderer::PointCloudRenderer(VulkanContext* vulkanContext, Camera* camera)
-    : m_vulkanContext(vulkanContext), m_camera(camera),
-      m_vertexBuffer(VK_NULL_HANDLE), m_vertexBufferMemory(VK_NULL_HANDLE),
+    : m_vulkanContext(vulkanContext), m_camera(camera), m_pointCount(0),
+      m_vertexBuffer(VK_NULL_HANDLE),
+      m_columnOffsets{}, m_mappedData(nullptr),
+      m_pointBudget(5000000), m_minNodePixels(40.0f), m_uploadBudget(1000000), m_drawnPointCount(0),
+      m_visibleNodeCount(0), m_drawnNodeCount(0), m_drawCallCount(0),
+      m_gpuCulling(false), m_cullShaderModule(VK_NULL_HANDLE),
+      m_cullDescriptorSetLayout(VK_NULL_HANDLE), m_cullDescriptorPool(VK_NULL_HANDLE),
+      m_cullDescriptorSet(VK_NULL_HANDLE), m_cullPipelineLayout(VK_NULL_HANDLE), m_cullPipeline(VK_NULL_HANDLE),
+      m_cullSpritePipeline(VK_NULL_HANDLE),
+      m_nodeBuffer(VK_NULL_HANDLE),
+      m_drawBuffer(VK_NULL_HANDLE), m_drawCounters(nullptr), m_cullEmittedOffset(0),
+      m_maxDrawIndirectCount(1),
+      m_pointSource(nullptr), m_paged(false), m_poolCapacity(0), m_pointMemoryLimit(0),
+      m_residentNodeCount(0), m_evictedNodeCount(0), m_residencyPending(false),
+      m_highlightIndex(-1),
       m_vertexShaderModule(VK_NULL_HANDLE), m_fragmentShaderModule(VK_NULL_HANDLE),
-      m_pipelineLayout(VK_NULL_HANDLE), m_graphicsPipeline(VK_NULL_HANDLE),
+      m_pipelineLayout(VK_NULL_HANDLE), m_graphicsPipeline(VK_NULL_HANDLE), m_pointShape(PointShape::Circle),
+      m_spritesEnabled(false), m_vertexPulling(false), m_hasLabels(false), m_columnsBound(false), m_maxPointSize(1.0f),
+      m_storageAlignment(16), m_maxStorageRange(0),
+      m_spriteVertexShaderModule(VK_NULL_HANDLE), m_spriteFragmentShaderModule(VK_NULL_HANDLE),
+      m_columnDescriptorSetLayout(VK_NULL_HANDLE), m_columnDescriptorPool(VK_NULL_HANDLE),
+      m_columnDescriptorSet(VK_NULL_HANDLE), m_columnPipelineLayout(VK_NULL_HANDLE), m_spritePipeline(VK_NULL_HANDLE),
+      m_pullVertexShaderModule(VK_NULL_HANDLE), m_pullFragmentShaderModule(VK_NULL_HANDLE), m_pullPipeline(VK_NULL_HANDLE),
+      m_spriteReloadTarget(this, true), m_pullReloadTarget(this, false),
+      m_timestampPool(VK_NULL_HANDLE), m_timestampPeriodNs(0.0),
+      m_gpuDrawTimeMs(0.0), m_gpuDrawTimeTotalMs(0.0), m_gpuDrawTimeSamples(0),
       m_initialized(false), m_hasData(false) {
 }
 
@@ -21,10 +110,59 @@ PointCloudRenderer::~PointCloudRenderer() {
 }
 
 bool PointCloudRenderer::init() {
+    Config& config = Config::getInstance();
+    m_pointBudget = static_cast<uint32_t>(config.getInt("point_budget", static_cast<int>(m_pointBudget)));
+    m_minNodePixels = config.getFloat("point_lod_min_pixels", m_minNodePixels);
+    m_pointMemoryLimit = static_cast<uint64_t>((std::max)(config.getInt("point_memory_mb", 0), 0)) * 1024 * 1024;
+
+    std::string shapeName = config.getString("point_shape", getPointShapeName(m_pointShape));
+    bool knownShape = false;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(PointShape::Count); i++) {
+        if (shapeName == getPointShapeName(static_cast<PointShape>(i))) {
+            m_pointShape = static_cast<PointShape>(i);
+            knownShape = true;
+        }
+    }
+    if (!knownShape) {
+        Logger::warn("Unknown point_shape '{}', using {}", shapeName, getPointShapeName(m_pointShape));
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_vulkanContext->getPhysicalDevice(), &properties);
+    m_maxPointSize = m_vulkanContext->getEnabledFeatures().largePoints ? properties.limits.pointSizeRange[1] : 1.0f;
+    m_storageAlignment = (std::max)(properties.limits.minStorageBufferOffsetAlignment, VkDeviceSize(16));
+    m_maxStorageRange = properties.limits.maxStorageBufferRange;
+    m_timestampPeriodNs = properties.limits.timestampPeriod;
+
     try {
         createShaderModules();
         createPipelineLayout();
         createGraphicsPipeline();
+
+        // Without the storage buffer paths only vertex attribute point lists are drawn
+        try {
+            createColumnResources();
+            std::string sprites = config.getString("point_sprites", "auto");
+            m_spritesEnabled = sprites == "on" || (sprites == "auto" && m_maxPointSize < 64.0f);
+            if (m_spritesEnabled) {
+                Logger::info("Drawing points as sprites (device point size limit {:.0f} px)", m_maxPointSize);
+            }
+            m_vertexPulling = config.getBool("point_vertex_pulling", false);
+        } catch (const std::exception& e) {
+            Logger::warn("Point sprites and vertex pulling unavailable: {}", e.what());
+            destroyColumnResources();
+        }
+        createTimestampQueries();
+
+        if (config.getBool("gpu_culling", true)) {
+            try {
+                createCullPipeline();
+                m_gpuCulling = true;
+            } catch (const std::exception& e) {
+                Logger::warn("GPU culling unavailable, falling back to CPU culling: {}", e.what());
+                destroyCullPipeline();
+            }
+        }
         
         m_initialized = true;
         Logger::info("PointCloudRenderer initialized successfully!");
@@ -41,95 +179,594 @@ void PointCloudRenderer::updatePoints(PluginContext* pluginContext) {
         return;
     }
 
-    bool needsUpdate = pluginContext->isPointCloudDirty() || pluginContext->isSelectionDirty();
+    bool needsUpdate = pluginContext->isPointCloudDirty() || pluginContext->isSelectionDirty() ||
+                       pluginContext->isPointLabelsDirty();
     if (!needsUpdate) {
         return;
     }
 
-    const auto& points = pluginContext->getPointCloudData();
-    if (points.empty()) {
+    size_t pointCount = pluginContext->getPointCount();
+    if (pointCount == 0) {
+        if (m_hasData) {
+            retireVertexBuffer();
+            m_octree.clear();
+        }
+        m_pointCount = 0;
+        m_drawnPointCount = 0;
+        m_visibleNodeCount = 0;
+        m_drawnNodeCount = 0;
+        m_drawCallCount = 0;
         m_hasData = false;
         pluginContext->setPointCloudDirty(false);
         pluginContext->setSelectionDirty(false);
+        pluginContext->setPointLabelsDirty(false);
         return;
     }
 
-    // Clean up old buffer
-    if (m_vertexBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(m_vulkanContext->getDevice(), m_vertexBuffer, nullptr);
-        m_vertexBuffer = VK_NULL_HANDLE;
+    // A selection change only patches the highlighted point and a label change
+    // only the label column, unless labels appear or disappear and change the layout
+    bool labelLayoutChanged = pluginContext->isPointLabelsDirty() && pluginContext->hasPointLabels() != m_hasLabels;
+    if (!pluginContext->isPointCloudDirty() && !labelLayoutChanged && m_hasData) {
+        if (pluginContext->isPointLabelsDirty()) {
+            updateLabels();
+            pluginContext->setPointLabelsDirty(false);
+        }
+        updateSelection(pluginContext);
+        pluginContext->setSelectionDirty(false);
+        return;
     }
-    if (m_vertexBufferMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(m_vulkanContext->getDevice(), m_vertexBufferMemory, nullptr);
-        m_vertexBufferMemory = VK_NULL_HANDLE;
+
+    // Retire the old buffer without waiting for the frames still reading it
+    retireVertexBuffer();
+
+    m_pointCount = static_cast<uint32_t>(pointCount);
+    buildHierarchy(pluginContext);
+    createVertexBuffer(pluginContext);
+    updateColumnDescriptorSet();
+    selectPipelines();
+    // The culling shader draws from the points' own offsets, which a paged pool does not have
+    if (m_gpuCulling && !m_paged) {
+        createCullBuffers();
     }
+    updateSelection(pluginContext);
+    m_hasData = true;
+    pluginContext->setPointCloudDirty(false);
+    pluginContext->setSelectionDirty(false);
+    pluginContext->setPointLabelsDirty(false);
 
-    int selectedIndex = pluginContext->getSelectedPointIndex();
+    Logger::info("PointCloudRenderer updated with {} points in {} LOD nodes{}{}", m_pointCount, m_octree.getNodes().size(),
+                 m_hasLabels ? ", labelled" : "", m_paged ? ", paged" : "");
+}
 
-    // Convert plugin points to vertices
-    m_vertices.clear();
-    m_vertices.reserve(points.size());
+void PointCloudRenderer::buildHierarchy(PluginContext* pluginContext) {
+    const std::shared_ptr<PointCache>& cache = pluginContext->getPointCache();
+    if (cache) {
+        // The cache stores its hierarchy and points in node order already
+        std::vector<PointOctreeNode> nodes(cache->getChunkCount());
+        for (uint32_t c = 0; c < cache->getChunkCount(); c++) {
+            const PointCacheChunk& chunk = cache->getChunks()[c];
+            nodes[c].boundsMin = glm::vec3(chunk.boundsMin[0], chunk.boundsMin[1], chunk.boundsMin[2]);
+            nodes[c].boundsMax = glm::vec3(chunk.boundsMax[0], chunk.boundsMax[1], chunk.boundsMax[2]);
+            nodes[c].firstPoint = chunk.firstPoint;
+            nodes[c].pointCount = chunk.pointCount;
+            nodes[c].firstChild = chunk.firstChild;
+            nodes[c].childCount = chunk.childCount;
+        }
+        m_octree.assign(std::move(nodes), m_pointCount);
+        return;
+    }
 
+    const auto& points = pluginContext->getPointCloudData();
+    std::vector<float> positions(points.size() * 3);
     for (size_t i = 0; i < points.size(); i++) {
-        const auto& p = points[i];
-        PointVertex v;
-        v.position = glm::vec3(p.x, p.y, p.z);
+        positions[i * 3 + 0] = points[i].x;
+        positions[i * 3 + 1] = points[i].y;
+        positions[i * 3 + 2] = points[i].z;
+    }
+    m_octree.build(positions.data(), points.size());
+}
+
+void PointCloudRenderer::createVertexBuffer(PluginContext* pluginContext) {
+    if (m_pointCount == 0) return;
+    m_pointSource = pluginContext;
+    m_hasLabels = pluginContext->hasPointLabels();
+
+    GpuAllocator& allocator = m_vulkanContext->getAllocator();
+    uint32_t capacity = choosePoolCapacity();
+    const uint32_t minimumCapacity = getMinimumPoolCapacity();
+    for (;;) {
+        // Column layout: positions | colors | sizes | labels, each sized for the
+        // pool and aligned for binding as a storage buffer; without labels the
+        // label column is empty
+        VkDeviceSize bufferSize = 0;
+        for (uint32_t column = 0; column < POINT_COLUMN_COUNT; column++) {
+            m_columnOffsets[column] = bufferSize;
+            if (column == POINT_COLUMN_LABEL && !m_hasLabels) {
+                continue;
+            }
+            VkDeviceSize columnSize = POINT_COLUMN_STRIDES[column] * capacity;
+            bufferSize += (columnSize + m_storageAlignment - 1) / m_storageAlignment * m_storageAlignment;
+        }
 
-        // Highlight selected point with yellow color and larger size
-        if ((int)i == selectedIndex) {
-            v.color = glm::vec3(1.0f, 1.0f, 0.0f);  // Yellow
-            v.size = p.size * 3.0f;  // 3x larger
-        } else {
-            v.color = glm::vec3(p.r, p.g, p.b);
-            v.size = p.size;
+        try {
+            allocator.createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                   VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                   m_vertexBuffer, m_vertexBufferMemory, GpuMemoryCategory::Points);
+            break;
+        } catch (const std::exception& e) {
+            // The budget is only an estimate; retry with a smaller pool
+            if (capacity <= minimumCapacity) {
+                throw;
+            }
+            Logger::warn("Point buffer for {} points failed ({}), retrying with half", capacity, e.what());
+            capacity = (std::max)(capacity / 2, minimumCapacity);
         }
-        m_vertices.push_back(v);
     }
 
-    createVertexBuffer();
-    m_hasData = true;
-    pluginContext->setPointCloudDirty(false);
-    pluginContext->setSelectionDirty(false);
+    // Keep the buffer mapped for paging and selection updates
+    m_mappedData = m_vertexBufferMemory.mapped;
+    m_poolCapacity = capacity;
+    m_paged = capacity < m_pointCount;
+    m_highlightIndex = -1;
 
-    if (pluginContext->isPointCloudDirty()) {
-        Logger::info("PointCloudRenderer updated with {} points", m_vertices.size());
-    }
-}
-
-void PointCloudRenderer::createVertexBuffer() {
-    if (m_vertices.empty()) return;
-    
-    VkDeviceSize bufferSize = sizeof(PointVertex) * m_vertices.size();
-    
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = bufferSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    
-    if (vkCreateBuffer(m_vulkanContext->getDevice(), &bufferInfo, nullptr, &m_vertexBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create point cloud vertex buffer!");
-    }
-    
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(m_vulkanContext->getDevice(), m_vertexBuffer, &memRequirements);
-    
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, 
+    const std::vector<PointOctreeNode>& nodes = m_octree.getNodes();
+    m_lastDrawnFrame.assign(nodes.size(), 0);
+    m_evictedNodeCount = 0;
+    // Empty nodes sort before the node that owns their first point
+    m_nodesByFirstPoint.resize(nodes.size());
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        m_nodesByFirstPoint[i] = i;
+    }
+    std::sort(m_nodesByFirstPoint.begin(), m_nodesByFirstPoint.end(), [&nodes](uint32_t a, uint32_t b) {
+        return nodes[a].firstPoint != nodes[b].firstPoint ? nodes[a].firstPoint < nodes[b].firstPoint
+                                                          : nodes[a].pointCount < nodes[b].pointCount;
+    });
+    if (!m_paged) {
+        writePoints(0, m_pointCount, 0);
+        m_residentFirst.resize(nodes.size());
+        for (size_t i = 0; i < nodes.size(); i++) {
+            m_residentFirst[i] = nodes[i].firstPoint;
+        }
+        m_residentNodeCount = static_cast<uint32_t>(nodes.size());
+        return;
+    }
+
+    // Paged: nodes are uploaded when first selected for drawing
+    m_residentFirst.assign(nodes.size(), UINT32_MAX);
+    m_residentNodeCount = 0;
+    m_poolFree.assign(1, PoolRange{0, capacity});
+}
+
+uint32_t PointCloudRenderer::choosePoolCapacity() const {
+    const VkDeviceSize bytesPerPoint = sizeof(float) * 7 + (m_hasLabels ? sizeof(uint32_t) : 0);
+
+    // Leave a quarter of the remaining budget to everything else
+    GpuMemoryBudget budget = m_vulkanContext->getAllocator().getBudget(
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    
-    if (vkAllocateMemory(m_vulkanContext->getDevice(), &allocInfo, nullptr, &m_vertexBufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate point cloud vertex buffer memory!");
+    VkDeviceSize available = budget.budget > budget.usage ? budget.budget - budget.usage : 0;
+    available -= available / 4;
+    if (m_pointMemoryLimit > 0) {
+        available = (std::min)(available, static_cast<VkDeviceSize>(m_pointMemoryLimit));
+    }
+
+    uint64_t capacity = (std::min)(static_cast<uint64_t>(available / bytesPerPoint), static_cast<uint64_t>(m_pointCount));
+    capacity = (std::max)(capacity, static_cast<uint64_t>(getMinimumPoolCapacity()));
+
+    Logger::info("Point memory: {} MB available of {} MB budget{}, {} of {} points resident at once",
+                 available / (1024 * 1024), budget.budget / (1024 * 1024),
+                 budget.fromExtension ? "" : " (estimated)", capacity, m_pointCount);
+    return static_cast<uint32_t>(capacity);
+}
+
+uint32_t PointCloudRenderer::getMinimumPoolCapacity() const {
+    // Room for several of the largest nodes so a view can always make progress
+    uint32_t largestNode = 0;
+    for (const PointOctreeNode& node : m_octree.getNodes()) {
+        largestNode = (std::max)(largestNode, node.pointCount);
+    }
+    uint64_t minimum = static_cast<uint64_t>(largestNode) * 8;
+    return static_cast<uint32_t>((std::min)(minimum, static_cast<uint64_t>(m_pointCount)));
+}
+
+void PointCloudRenderer::writePoints(uint32_t first, uint32_t count, uint32_t dst) {
+    char* base = static_cast<char*>(m_mappedData);
+    float* positions = reinterpret_cast<float*>(base + m_columnOffsets[POINT_COLUMN_POSITION]) + dst * 3;
+    float* colors = reinterpret_cast<float*>(base + m_columnOffsets[POINT_COLUMN_COLOR]) + dst * 3;
+    float* sizes = reinterpret_cast<float*>(base + m_columnOffsets[POINT_COLUMN_SIZE]) + dst;
+
+    const std::shared_ptr<PointCache>& cache = m_pointSource->getPointCache();
+    if (cache) {
+        // Cached columns already have the GPU layout, copy them straight from the mapping
+        memcpy(positions, cache->getPositions() + first * 3, sizeof(float) * 3 * count);
+        memcpy(colors, cache->getColors() + first * 3, sizeof(float) * 3 * count);
+        memcpy(sizes, cache->getSizes() + first, sizeof(float) * count);
+    } else {
+        // Gather plugin points into hierarchy order
+        const auto& points = m_pointSource->getPointCloudData();
+        const std::vector<uint32_t>& order = m_octree.getOrder();
+        for (uint32_t i = 0; i < count; i++) {
+            const auto& p = points[order[first + i]];
+            positions[i * 3 + 0] = p.x;
+            positions[i * 3 + 1] = p.y;
+            positions[i * 3 + 2] = p.z;
+            colors[i * 3 + 0] = p.r;
+            colors[i * 3 + 1] = p.g;
+            colors[i * 3 + 2] = p.b;
+            sizes[i] = p.size;
+        }
+    }
+    if (m_hasLabels) {
+        writeLabels(first, count, dst);
+    }
+
+    // A re-uploaded node gets its highlight back; no frame reads its range yet
+    if (m_highlightIndex >= first && m_highlightIndex < static_cast<int64_t>(first) + count) {
+        writeHighlight(m_highlightIndex, dst + (m_highlightIndex - first), true, false);
+    }
+}
+
+void PointCloudRenderer::makeResident(std::vector<uint32_t>& selected) {
+    const std::vector<PointOctreeNode>& nodes = m_octree.getNodes();
+    uint64_t frameNumber = m_vulkanContext->getFrameNumber();
+    uint64_t frameCount = m_vulkanContext->getFrameCount();
+    // Bounds the upload work per frame; the rest of the view fills in over the next frames
+    uint32_t uploadBudget = m_uploadBudget;
+
+    bool candidatesSorted = false;
+    size_t nextCandidate = 0;
+    size_t kept = 0;
+    // Set when a skipped node can be uploaded by a later frame; a node that
+    // does not fit the pool even after evicting everything else never will
+    m_residencyPending = false;
+    for (uint32_t nodeIndex : selected) {
+        const PointOctreeNode& node = nodes[nodeIndex];
+        if (m_residentFirst[nodeIndex] == UINT32_MAX) {
+            if (node.pointCount > uploadBudget) {
+                m_residencyPending = true;
+                continue;
+            }
+
+            uint32_t first = 0;
+            bool allocated = allocatePoolRange(node.pointCount, first);
+            while (!allocated) {
+                // Least recently drawn nodes first
+                if (!candidatesSorted) {
+                    m_evictionCandidates.clear();
+                    for (uint32_t i = 0; i < nodes.size(); i++) {
+                        if (m_residentFirst[i] != UINT32_MAX) {
+                            m_evictionCandidates.push_back(i);
+                        }
+                    }
+                    std::sort(m_evictionCandidates.begin(), m_evictionCandidates.end(), [this](uint32_t a, uint32_t b) {
+                        return m_lastDrawnFrame[a] < m_lastDrawnFrame[b];
+                    });
+                    candidatesSorted = true;
+                }
+                if (nextCandidate == m_evictionCandidates.size()) {
+                    break;
+                }
+
+                // Only nodes that no frame in flight still reads can be overwritten
+                uint32_t victim = m_evictionCandidates[nextCandidate++];
+                if (m_residentFirst[victim] == UINT32_MAX) {
+                    continue;
+                }
+                if (m_lastDrawnFrame[victim] + frameCount > frameNumber) {
+                    // Not drawn this frame: it can be evicted once its frames complete
+                    if (m_lastDrawnFrame[victim] < frameNumber) {
+                        m_residencyPending = true;
+                    }
+                    continue;
+                }
+                releasePoolRange(m_residentFirst[victim], nodes[victim].pointCount);
+                m_residentFirst[victim] = UINT32_MAX;
+                m_residentNodeCount--;
+                m_evictedNodeCount++;
+                allocated = allocatePoolRange(node.pointCount, first);
+            }
+            if (!allocated) {
+                continue;
+            }
+
+            writePoints(node.firstPoint, node.pointCount, first);
+            m_residentFirst[nodeIndex] = first;
+            m_residentNodeCount++;
+            uploadBudget -= node.pointCount;
+        }
+        m_lastDrawnFrame[nodeIndex] = frameNumber;
+        selected[kept++] = nodeIndex;
+    }
+    selected.resize(kept);
+}
+
+bool PointCloudRenderer::allocatePoolRange(uint32_t count, uint32_t& first) {
+    for (size_t i = 0; i < m_poolFree.size(); i++) {
+        PoolRange& range = m_poolFree[i];
+        if (range.count < count) {
+            continue;
+        }
+        first = range.first;
+        range.first += count;
+        range.count -= count;
+        if (range.count == 0) {
+            m_poolFree.erase(m_poolFree.begin() + i);
+        }
+        return true;
+    }
+    return false;
+}
+
+void PointCloudRenderer::releasePoolRange(uint32_t first, uint32_t count) {
+    auto next = std::lower_bound(m_poolFree.begin(), m_poolFree.end(), first,
+                                 [](const PoolRange& range, uint32_t value) { return range.first < value; });
+    next = m_poolFree.insert(next, PoolRange{first, count});
+
+    // Merge with the following and preceding ranges
+    auto following = next + 1;
+    if (following != m_poolFree.end() && next->first + next->count == following->first) {
+        next->count += following->count;
+        m_poolFree.erase(following);
+    }
+    if (next != m_poolFree.begin()) {
+        auto preceding = next - 1;
+        if (preceding->first + preceding->count == next->first) {
+            preceding->count += next->count;
+            m_poolFree.erase(next);
+        }
+    }
+}
+
+uint32_t PointCloudRenderer::findNode(int64_t index) const {
+    const std::vector<PointOctreeNode>& nodes = m_octree.getNodes();
+    auto it = std::upper_bound(m_nodesByFirstPoint.begin(), m_nodesByFirstPoint.end(), index,
+                               [&nodes](int64_t value, uint32_t node) { return value < nodes[node].firstPoint; });
+    if (index < 0 || it == m_nodesByFirstPoint.begin()) {
+        return UINT32_MAX;
+    }
+    uint32_t nodeIndex = *(it - 1);
+    if (index >= static_cast<int64_t>(nodes[nodeIndex].firstPoint) + nodes[nodeIndex].pointCount) {
+        return UINT32_MAX;
+    }
+    return nodeIndex;
+}
+
+int64_t PointCloudRenderer::findResidentPoint(int64_t index, uint32_t* residentNode) const {
+    if (index < 0 || !m_paged) {
+        return index;
+    }
+
+    uint32_t nodeIndex = findNode(index);
+    if (nodeIndex == UINT32_MAX || m_residentFirst[nodeIndex] == UINT32_MAX) {
+        return -1;
+    }
+    if (residentNode) {
+        *residentNode = nodeIndex;
+    }
+    return m_residentFirst[nodeIndex] + (index - m_octree.getNodes()[nodeIndex].firstPoint);
+}
+
+void PointCloudRenderer::updateSelection(PluginContext* pluginContext) {
+    if (!m_mappedData) return;
+
+    int selectedIndex = pluginContext->getSelectedPointIndex();
+    int64_t newHighlight = -1;
+    if (selectedIndex >= 0 && static_cast<uint32_t>(selectedIndex) < m_pointCount) {
+        const std::vector<uint32_t>& inverseOrder = m_octree.getInverseOrder();
+        newHighlight = inverseOrder.empty() ? selectedIndex : inverseOrder[selectedIndex];
+    }
+    if (newHighlight == m_highlightIndex) return;
+
+    // Frames in flight may still read both points, so the patches are staged
+    // instead of written through the mapping. Restore the previously
+    // highlighted point; an evicted node has nothing to restore
+    uint32_t nodeIndex = 0;
+    int64_t location = findResidentPoint(m_highlightIndex, &nodeIndex);
+    if (location >= 0) {
+        writeHighlight(m_highlightIndex, location, false, true);
+        keepResident(nodeIndex);
+    }
+
+    // A point whose node is not resident is highlighted when the node is uploaded
+    m_highlightIndex = newHighlight;
+    location = findResidentPoint(m_highlightIndex, &nodeIndex);
+    if (location >= 0) {
+        writeHighlight(m_highlightIndex, location, true, true);
+        keepResident(nodeIndex);
+    }
+}
+
+void PointCloudRenderer::writeHighlight(int64_t index, int64_t location, bool highlighted, bool staged) {
+    // The original values come from the point source, never from the buffer,
+    // which may still have staged patches pending
+    float color[3];
+    float size = 0.0f;
+    uint32_t label = 0;
+    const std::shared_ptr<PointCache>& cache = m_pointSource->getPointCache();
+    if (cache) {
+        memcpy(color, cache->getColors() + index * 3, sizeof(color));
+        size = cache->getSizes()[index];
+    } else {
+        const auto& p = m_pointSource->getPointCloudData()[m_octree.getOrder()[index]];
+        color[0] = p.r;
+        color[1] = p.g;
+        color[2] = p.b;
+        size = p.size;
+    }
+    if (m_hasLabels) {
+        const std::vector<uint32_t>& labels = m_pointSource->getPointLabels();
+        label = labels[cache ? index : m_octree.getOrder()[index]];
+    }
+
+    // Highlight selected point with yellow color and larger size; label 0
+    // keeps the highlight color in the label-coloring paths
+    if (highlighted) {
+        color[0] = 1.0f;
+        color[1] = 1.0f;
+        color[2] = 0.0f;
+        size *= 3.0f;  // 3x larger
+        label = 0;
+    }
+
+    const VkDeviceSize columnOffsets[POINT_COLUMN_COUNT] = {
+        0,
+        m_columnOffsets[POINT_COLUMN_COLOR] + location * POINT_COLUMN_STRIDES[POINT_COLUMN_COLOR],
+        m_columnOffsets[POINT_COLUMN_SIZE] + location * POINT_COLUMN_STRIDES[POINT_COLUMN_SIZE],
+        m_columnOffsets[POINT_COLUMN_LABEL] + location * POINT_COLUMN_STRIDES[POINT_COLUMN_LABEL]
+    };
+    if (staged) {
+        // The upload batch starts with a barrier after all earlier work on the
+        // queue, so the copy lands once the frames in flight are done reading
+        UploadBatcher& uploads = m_vulkanContext->getUploadBatcher();
+        uploads.upload(m_vertexBuffer, columnOffsets[POINT_COLUMN_COLOR], color, sizeof(color));
+        uploads.upload(m_vertexBuffer, columnOffsets[POINT_COLUMN_SIZE], &size, sizeof(size));
+        if (m_hasLabels) {
+            uploads.upload(m_vertexBuffer, columnOffsets[POINT_COLUMN_LABEL], &label, sizeof(label));
+        }
+    } else {
+        char* base = static_cast<char*>(m_mappedData);
+        memcpy(base + columnOffsets[POINT_COLUMN_COLOR], color, sizeof(color));
+        memcpy(base + columnOffsets[POINT_COLUMN_SIZE], &size, sizeof(size));
+        if (m_hasLabels) {
+            memcpy(base + columnOffsets[POINT_COLUMN_LABEL], &label, sizeof(label));
+        }
+    }
+}
+
+void PointCloudRenderer::keepResident(uint32_t nodeIndex) {
+    // A staged patch is copied when this frame is submitted; evicting the node
+    // before then would let the copy overwrite the node uploaded in its place
+    if (m_paged) {
+        m_lastDrawnFrame[nodeIndex] = m_vulkanContext->getFrameNumber();
+    }
+}
+
+void PointCloudRenderer::gatherLabels(uint32_t first, uint32_t count, uint32_t* labels) const {
+    const std::vector<uint32_t>& source = m_pointSource->getPointLabels();
+    if (m_pointSource->getPointCache()) {
+        // Cached points are stored in node order
+        memcpy(labels, source.data() + first, sizeof(uint32_t) * count);
+    } else {
+        const std::vector<uint32_t>& order = m_octree.getOrder();
+        for (uint32_t i = 0; i < count; i++) {
+            labels[i] = source[order[first + i]];
+        }
+    }
+}
+
+void PointCloudRenderer::writeLabels(uint32_t first, uint32_t count, uint32_t dst) {
+    uint32_t* labels = reinterpret_cast<uint32_t*>(static_cast<char*>(m_mappedData) + m_columnOffsets[POINT_COLUMN_LABEL]) + dst;
+    gatherLabels(first, count, labels);
+}
+
+void PointCloudRenderer::uploadLabels(uint32_t first, uint32_t count, uint32_t dst) {
+    std::vector<uint32_t> labels(count);
+    gatherLabels(first, count, labels.data());
+    m_vulkanContext->getUploadBatcher().upload(m_vertexBuffer,
+        m_columnOffsets[POINT_COLUMN_LABEL] + static_cast<VkDeviceSize>(dst) * POINT_COLUMN_STRIDES[POINT_COLUMN_LABEL],
+        labels.data(), sizeof(uint32_t) * count);
+}
+
+void PointCloudRenderer::updateLabels() {
+    if (!m_mappedData || !m_hasLabels) return;
+
+    // Find the nodes holding a changed label; cached points are in node order,
+    // so a range walks node by node instead of point by point
+    const std::vector<PointOctreeNode>& nodes = m_octree.getNodes();
+    const std::vector<uint32_t>& inverseOrder = m_octree.getInverseOrder();
+    bool nodeOrder = m_pointSource->getPointCache() || inverseOrder.empty();
+    m_labelNodeDirty.assign(nodes.size(), 0);
+    m_dirtyLabelNodes.clear();
+    for (const auto& range : m_pointSource->getDirtyPointLabelRanges()) {
+        size_t end = (std::min)(range.first + range.count, static_cast<size_t>(m_pointCount));
+        for (size_t i = range.first; i < end;) {
+            uint32_t nodeIndex = findNode(nodeOrder ? static_cast<int64_t>(i) : inverseOrder[i]);
+            if (nodeIndex == UINT32_MAX) {
+                i++;
+                continue;
+            }
+            if (!m_labelNodeDirty[nodeIndex]) {
+                m_labelNodeDirty[nodeIndex] = 1;
+                m_dirtyLabelNodes.push_back(nodeIndex);
+            }
+            i = nodeOrder ? nodes[nodeIndex].firstPoint + nodes[nodeIndex].pointCount : i + 1;
+        }
+    }
+
+    // Frames in flight may still read the label column, so the changed nodes'
+    // labels are staged; the upload batch is ordered after them on the queue.
+    // Evicted nodes get their labels when they are uploaded again
+    for (uint32_t nodeIndex : m_dirtyLabelNodes) {
+        if (m_residentFirst[nodeIndex] != UINT32_MAX) {
+            uploadLabels(nodes[nodeIndex].firstPoint, nodes[nodeIndex].pointCount, m_residentFirst[nodeIndex]);
+            keepResident(nodeIndex);
+        }
+    }
+
+    // A staged node overwrote the highlighted point's label
+    uint32_t highlightNode = findNode(m_highlightIndex);
+    int64_t location = findResidentPoint(m_highlightIndex);
+    if (highlightNode != UINT32_MAX && m_labelNodeDirty[highlightNode] && location >= 0) {
+        writeHighlight(m_highlightIndex, location, true, true);
+    }
+}
+
+void PointCloudRenderer::destroyVertexBuffer() {
+    destroyCullBuffers();
+    m_columnsBound = false;
+    m_hasLabels = false;
+    m_mappedData = nullptr;
+    m_highlightIndex = -1;
+    m_paged = false;
+    m_poolCapacity = 0;
+    m_residentFirst.clear();
+    m_lastDrawnFrame.clear();
+    m_nodesByFirstPoint.clear();
+    m_poolFree.clear();
+    m_residentNodeCount = 0;
+    m_residencyPending = false;
+    m_vulkanContext->getAllocator().destroyBuffer(m_vertexBuffer, m_vertexBufferMemory);
+}
+
+void PointCloudRenderer::retireVertexBuffer() {
+    // Frames in flight may still draw from the point buffers and bind their
+    // descriptor sets; they are destroyed once this frame slot has completed
+    VkDevice device = m_vulkanContext->getDevice();
+    GpuAllocator* allocator = &m_vulkanContext->getAllocator();
+    VkBuffer buffers[3] = {m_vertexBuffer, m_nodeBuffer, m_drawBuffer};
+    GpuAllocation memory[3] = {m_vertexBufferMemory, m_nodeBufferMemory, m_drawBufferMemory};
+    VkDescriptorPool pools[2] = {m_columnDescriptorPool, m_cullDescriptorPool};
+    m_vulkanContext->deferDelete([device, allocator, buffers, memory, pools]() mutable {
+        for (int i = 0; i < 3; i++) {
+            allocator->destroyBuffer(buffers[i], memory[i]);
+        }
+        for (VkDescriptorPool pool : pools) {
+            if (pool != VK_NULL_HANDLE) {
+                vkDestroyDescriptorPool(device, pool, nullptr);
+            }
+        }
+    });
+
+    m_vertexBuffer = VK_NULL_HANDLE;
+    m_vertexBufferMemory = GpuAllocation();
+    m_nodeBuffer = VK_NULL_HANDLE;
+    m_nodeBufferMemory = GpuAllocation();
+    m_drawBuffer = VK_NULL_HANDLE;
+    m_drawBufferMemory = GpuAllocation();
+    m_columnDescriptorPool = VK_NULL_HANDLE;
+    m_columnDescriptorSet = VK_NULL_HANDLE;
+    m_cullDescriptorPool = VK_NULL_HANDLE;
+    m_cullDescriptorSet = VK_NULL_HANDLE;
+    // Resets the remaining state; the handles are already gone
+    destroyVertexBuffer();
+
+    // The next buffer gets descriptor sets no frame has bound yet
+    if (m_columnDescriptorSetLayout != VK_NULL_HANDLE) {
+        createColumnDescriptorSet();
+    }
+    if (m_cullDescriptorSetLayout != VK_NULL_HANDLE) {
+        createCullDescriptorSet();
     }
-    
-    vkBindBufferMemory(m_vulkanContext->getDevice(), m_vertexBuffer, m_vertexBufferMemory, 0);
-    
-    void* data;
-    vkMapMemory(m_vulkanContext->getDevice(), m_vertexBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, m_vertices.data(), (size_t)bufferSize);
-    vkUnmapMemory(m_vulkanContext->getDevice(), m_vertexBufferMemory);
 }
 
 void PointCloudRenderer::createShaderModules() {
@@ -156,130 +793,207 @@ void PointCloudRenderer::createPipelineLayout() {
 }
 
 void PointCloudRenderer::createGraphicsPipeline() {
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = m_vertexShaderModule;
-    vertShaderStageInfo.pName = "main";
-    
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = m_fragmentShaderModule;
-    fragShaderStageInfo.pName = "main";
-    
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
-
-    // Vertex input
-    VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(PointVertex);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-    std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(PointVertex, position);
-
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(PointVertex, color);
-
-    attributeDescriptions[2].binding = 0;
-    attributeDescriptions[2].location = 2;
-    attributeDescriptions[2].format = VK_FORMAT_R32_SFLOAT;
-    attributeDescriptions[2].offset = offsetof(PointVertex, size);
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.scissorCount = 1;
-
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_NONE;
-    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    VkPipelineDepthStencilStateCreateInfo depthStencil{};
-    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-    depthStencil.depthBoundsTestEnable = VK_FALSE;
-    depthStencil.stencilTestEnable = VK_FALSE;
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-                                          VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
-
-    std::vector<VkDynamicState> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
-    VkPipelineDynamicStateCreateInfo dynamicState{};
-    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-    dynamicState.pDynamicStates = dynamicStates.data();
-
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = &depthStencil;
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = m_pipelineLayout;
-    pipelineInfo.renderPass = m_vulkanContext->getRenderPass();
-    pipelineInfo.subpass = 0;
-
-    if (vkCreateGraphicsPipelines(m_vulkanContext->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create point cloud graphics pipeline!");
-    }
-}
-
-uint32_t PointCloudRenderer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(m_vulkanContext->getPhysicalDevice(), &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
-    }
-    throw std::runtime_error("Failed to find suitable memory type!");
+    // All shapes are built up front so switching never stalls a frame
+    buildShapePipelines(m_vertexShaderModule, m_fragmentShaderModule);
+    m_graphicsPipeline = m_vulkanContext->getPipelineBuilder().getPipeline(
+        makePipelineKey(m_vertexShaderModule, m_fragmentShaderModule, m_pointShape));
+}
+
+VkPipeline PointCloudRenderer::buildShapePipelines(VkShaderModule vertexShader, VkShaderModule fragmentShader) {
+    PipelineBuilder& builder = m_vulkanContext->getPipelineBuilder();
+    VkPipeline circlePipeline = VK_NULL_HANDLE;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(PointShape::Count); i++) {
+        PointShape shape = static_cast<PointShape>(i);
+        VkPipeline pipeline = builder.getPipeline(makePipelineKey(vertexShader, fragmentShader, shape));
+        if (shape == PointShape::Circle) {
+            circlePipeline = pipeline;
+        }
+    }
+    return circlePipeline;
+}
+
+PipelineKey PointCloudRenderer::makePipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader,
+                                                PointShape shape) const {
+    PipelineKey key;
+    key.vertexShader = vertexShader;
+    key.fragmentShader = fragmentShader;
+    key.layout = m_pipelineLayout;
+    key.renderPass = m_vulkanContext->getRenderPass();
+
+    // Vertex input: one binding per column
+    key.bindings = {
+        {POINT_COLUMN_POSITION, sizeof(float) * 3, VK_VERTEX_INPUT_RATE_VERTEX},
+        {POINT_COLUMN_COLOR, sizeof(float) * 3, VK_VERTEX_INPUT_RATE_VERTEX},
+        {POINT_COLUMN_SIZE, sizeof(float), VK_VERTEX_INPUT_RATE_VERTEX}
+    };
+    key.attributes = {
+        {0, POINT_COLUMN_POSITION, VK_FORMAT_R32G32B32_SFLOAT, 0},
+        {1, POINT_COLUMN_COLOR, VK_FORMAT_R32G32B32_SFLOAT, 0},
+        {2, POINT_COLUMN_SIZE, VK_FORMAT_R32_SFLOAT, 0}
+    };
+    key.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+    applyPointShape(key, shape);
+    return key;
+}
+
+PipelineKey PointCloudRenderer::makeSpritePipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader,
+                                                      PointShape shape, bool labels) const {
+    PipelineKey key;
+    key.vertexShader = vertexShader;
+    key.fragmentShader = fragmentShader;
+    key.layout = m_columnPipelineLayout;
+    key.renderPass = m_vulkanContext->getRenderPass();
+
+    // No vertex input: the vertex shader pulls the points from storage buffers
+    key.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    key.vertexConstants = {labels ? 1u : 0u};
+    applyPointShape(key, shape);
+    return key;
+}
+
+PipelineKey PointCloudRenderer::makePullPipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader,
+                                                    PointShape shape, bool labels) const {
+    PipelineKey key;
+    key.vertexShader = vertexShader;
+    key.fragmentShader = fragmentShader;
+    key.layout = m_columnPipelineLayout;
+    key.renderPass = m_vulkanContext->getRenderPass();
+
+    key.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+    // The label column is only read by the HAS_LABELS variant
+    key.vertexConstants = {labels ? 1u : 0u};
+    applyPointShape(key, shape);
+    return key;
+}
+
+void PointCloudRenderer::selectPipelines() {
+    PipelineBuilder& builder = m_vulkanContext->getPipelineBuilder();
+    if (m_graphicsPipeline != VK_NULL_HANDLE) {
+        m_graphicsPipeline = builder.getPipeline(makePipelineKey(m_vertexShaderModule, m_fragmentShaderModule, m_pointShape));
+    }
+    if (m_spritePipeline != VK_NULL_HANDLE) {
+        m_spritePipeline = builder.getPipeline(makeSpritePipelineKey(m_spriteVertexShaderModule, m_spriteFragmentShaderModule, m_pointShape, m_hasLabels));
+    }
+    if (m_pullPipeline != VK_NULL_HANDLE) {
+        m_pullPipeline = builder.getPipeline(makePullPipelineKey(m_pullVertexShaderModule, m_pullFragmentShaderModule, m_pointShape, m_hasLabels));
+    }
+}
+
+void PointCloudRenderer::setPointShape(PointShape shape) {
+    if (shape == m_pointShape || shape >= PointShape::Count) {
+        return;
+    }
+    m_pointShape = shape;
+    selectPipelines();
+}
+
+void PointCloudRenderer::setSpritesEnabled(bool enabled) {
+    if (enabled == m_spritesEnabled) {
+        return;
+    }
+    m_spritesEnabled = enabled;
+    m_gpuDrawTimeTotalMs = 0.0;
+    m_gpuDrawTimeSamples = 0;
+}
+
+bool PointCloudRenderer::isDrawingSprites() const {
+    return m_spritesEnabled && m_spritePipeline != VK_NULL_HANDLE && m_columnsBound;
+}
+
+void PointCloudRenderer::setVertexPulling(bool enabled) {
+    if (enabled == m_vertexPulling) {
+        return;
+    }
+    m_vertexPulling = enabled;
+    m_gpuDrawTimeTotalMs = 0.0;
+    m_gpuDrawTimeSamples = 0;
+}
+
+bool PointCloudRenderer::isPullingVertices() const {
+    return m_vertexPulling && m_pullPipeline != VK_NULL_HANDLE && m_columnsBound && !isDrawingSprites();
+}
+
+const char* PointCloudRenderer::getDrawPathName() const {
+    if (isDrawingSprites()) {
+        return "sprites";
+    }
+    return isPullingVertices() ? "pulled" : "points";
+}
+
+double PointCloudRenderer::getAverageGpuDrawTimeMs() const {
+    return m_gpuDrawTimeSamples > 0 ? m_gpuDrawTimeTotalMs / static_cast<double>(m_gpuDrawTimeSamples) : 0.0;
+}
+
+const char* PointCloudRenderer::getPointShapeName(PointShape shape) {
+    switch (shape) {
+        case PointShape::Square: return "square";
+        case PointShape::Circle: return "circle";
+        case PointShape::Smooth: return "smooth";
+        case PointShape::Gaussian: return "gaussian";
+        default: return "unknown";
+    }
+}
+
+VkPipeline PointCloudRenderer::buildPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader) {
+    // The shape may change before the result is applied, so build all of them
+    return buildShapePipelines(vertexShader, fragmentShader);
+}
+
+void PointCloudRenderer::replaceShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkPipeline pipeline) {
+    // Points are recorded every frame, so the next draw picks up the new pipeline
+    ShaderHotReloader::retireShaders(m_vulkanContext, m_vertexShaderModule, m_fragmentShaderModule);
+    m_vertexShaderModule = vertexShader;
+    m_fragmentShaderModule = fragmentShader;
+    m_graphicsPipeline = m_pointShape == PointShape::Circle
+        ? pipeline
+        : m_vulkanContext->getPipelineBuilder().getPipeline(makePipelineKey(vertexShader, fragmentShader, m_pointShape));
+}
+
+void PointCloudRenderer::buildColumnPipelines(bool sprites, VkShaderModule vertexShader, VkShaderModule fragmentShader) {
+    PipelineBuilder& builder = m_vulkanContext->getPipelineBuilder();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(PointShape::Count); i++) {
+        for (bool labels : {false, true}) {
+            PointShape shape = static_cast<PointShape>(i);
+            builder.getPipeline(sprites ? makeSpritePipelineKey(vertexShader, fragmentShader, shape, labels)
+                                        : makePullPipelineKey(vertexShader, fragmentShader, shape, labels));
+        }
+    }
+}
+
+ShaderReloadTarget* PointCloudRenderer::getSpriteReloadTarget() {
+    return m_columnPipelineLayout != VK_NULL_HANDLE ? &m_spriteReloadTarget : nullptr;
+}
+
+ShaderReloadTarget* PointCloudRenderer::getPullReloadTarget() {
+    return m_columnPipelineLayout != VK_NULL_HANDLE ? &m_pullReloadTarget : nullptr;
+}
+
+VkPipeline PointCloudRenderer::ColumnProgramReloadTarget::buildPipeline(VkShaderModule vertexShader,
+                                                                        VkShaderModule fragmentShader) {
+    // The shape and label column may change before the result is applied
+    m_renderer->buildColumnPipelines(m_sprites, vertexShader, fragmentShader);
+    return VK_NULL_HANDLE;
+}
+
+void PointCloudRenderer::ColumnProgramReloadTarget::replaceShaders(VkShaderModule vertexShader,
+                                                                   VkShaderModule fragmentShader, VkPipeline) {
+    m_renderer->replaceColumnShaders(m_sprites, vertexShader, fragmentShader);
+}
+
+void PointCloudRenderer::replaceColumnShaders(bool sprites, VkShaderModule vertexShader, VkShaderModule fragmentShader) {
+    // The pipelines were built into the pipeline builder; pick the current variant
+    PipelineBuilder& builder = m_vulkanContext->getPipelineBuilder();
+    if (sprites) {
+        ShaderHotReloader::retireShaders(m_vulkanContext, m_spriteVertexShaderModule, m_spriteFragmentShaderModule);
+        m_spriteVertexShaderModule = vertexShader;
+        m_spriteFragmentShaderModule = fragmentShader;
+        m_spritePipeline = builder.getPipeline(makeSpritePipelineKey(vertexShader, fragmentShader, m_pointShape, m_hasLabels));
+    } else {
+        ShaderHotReloader::retireShaders(m_vulkanContext, m_pullVertexShaderModule, m_pullFragmentShaderModule);
+        m_pullVertexShaderModule = vertexShader;
+        m_pullFragmentShaderModule = fragmentShader;
+        m_pullPipeline = builder.getPipeline(makePullPipelineKey(vertexShader, fragmentShader, m_pointShape, m_hasLabels));
+    }
 }
 
 void PointCloudRenderer::draw(VkCommandBuffer commandBuffer) {
@@ -287,18 +1001,32 @@ void PointCloudRenderer::draw(VkCommandBuffer commandBuffer) {
         return;
     }
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+    uint32_t frameSlot = static_cast<uint32_t>(m_vulkanContext->getCurrentFrame());
+    if (m_timestampPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, frameSlot * 2);
+    }
 
-    glm::mat4 model = glm::mat4(1.0f);
-    glm::mat4 view = m_camera->getViewMatrix();
-    glm::mat4 proj = m_camera->getProjectionMatrix();
-    glm::mat4 mvp = proj * view * model;
+    // Points are in world space, so the model matrix is identity
+    const glm::mat4& mvp = m_camera->getViewProjectionMatrix();
+    VkExtent2D extent = m_vulkanContext->getSwapchainExtent();
 
-    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &mvp);
+    bool sprites = isDrawingSprites();
+    if (sprites || isPullingVertices()) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, sprites ? m_spritePipeline : m_pullPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_columnPipelineLayout,
+                                0, 1, &m_columnDescriptorSet, 0, nullptr);
+        ColumnPushConstants pushConstants{};
+        pushConstants.mvp = mvp;
+        pushConstants.viewportSize = glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+        vkCmdPushConstants(commandBuffer, m_columnPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+                           0, sizeof(pushConstants), &pushConstants);
+    } else {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &mvp);
 
-    VkBuffer vertexBuffers[] = {m_vertexBuffer};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+        VkBuffer vertexBuffers[POINT_ATTRIBUTE_COLUMN_COUNT] = {m_vertexBuffer, m_vertexBuffer, m_vertexBuffer};
+        vkCmdBindVertexBuffers(commandBuffer, 0, POINT_ATTRIBUTE_COLUMN_COUNT, vertexBuffers, m_columnOffsets);
+    }
 
     VkViewport viewport{};
     viewport.x = 0.0f;
@@ -314,14 +1042,616 @@ void PointCloudRenderer::draw(VkCommandBuffer commandBuffer) {
     scissor.extent = m_vulkanContext->getSwapchainExtent();
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    vkCmdDraw(commandBuffer, static_cast<uint32_t>(m_vertices.size()), 1, 0, 0);
+    if (useIndirectDraws()) {
+        drawIndirect(commandBuffer);
+    } else {
+        drawCulled(commandBuffer);
+    }
+
+    if (m_timestampPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, frameSlot * 2 + 1);
+        m_timestampsWritten[frameSlot] = 1;
+    }
+}
+
+void PointCloudRenderer::drawRange(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count, bool sprites) {
+    if (sprites) {
+        // One quad instance per point; gl_InstanceIndex is the point index
+        vkCmdDraw(commandBuffer, 4, count, 0, first);
+    } else {
+        vkCmdDraw(commandBuffer, count, 1, first, 0);
+    }
+}
+
+bool PointCloudRenderer::useIndirectDraws() const {
+    if (!m_gpuCulling || m_drawBuffer == VK_NULL_HANDLE) {
+        return false;
+    }
+    // Instanced indirect draws start at the node's first point through firstInstance
+    return !isDrawingSprites() || m_vulkanContext->getEnabledFeatures().drawIndirectFirstInstance;
+}
+
+void PointCloudRenderer::resetTimestamps(VkCommandBuffer commandBuffer) {
+    if (m_timestampPool == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // This frame slot's fence has been waited on, so its queries are available
+    uint32_t frameSlot = static_cast<uint32_t>(m_vulkanContext->getCurrentFrame());
+    if (m_timestampsWritten[frameSlot]) {
+        uint64_t timestamps[2] = {0, 0};
+        VkResult result = vkGetQueryPoolResults(m_vulkanContext->getDevice(), m_timestampPool, frameSlot * 2, 2,
+                                                sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        if (result == VK_SUCCESS && timestamps[1] >= timestamps[0]) {
+            m_gpuDrawTimeMs = static_cast<double>(timestamps[1] - timestamps[0]) * m_timestampPeriodNs / 1.0e6;
+            m_gpuDrawTimeTotalMs += m_gpuDrawTimeMs;
+            m_gpuDrawTimeSamples++;
+        }
+        m_timestampsWritten[frameSlot] = 0;
+    }
+    vkCmdResetQueryPool(commandBuffer, m_timestampPool, frameSlot * 2, 2);
+}
+
+void PointCloudRenderer::drawCulled(VkCommandBuffer commandBuffer) {
+    const glm::mat4& viewProjection = m_camera->getViewProjectionMatrix();
+    VkExtent2D extent = m_vulkanContext->getSwapchainExtent();
+
+    // Cull node bounds against the view frustum
+    const AabbArray& nodeBounds = m_octree.getNodeBounds();
+    m_nodeVisibility.resize(nodeBounds.count);
+    Frustum frustum = Frustum::fromViewProjection(viewProjection);
+    m_visibleNodeCount = static_cast<uint32_t>(frustum.cull(nodeBounds, m_nodeVisibility.data()));
+
+    // Pick LOD nodes among the visible ones and draw their point ranges,
+    // merging ranges that are adjacent in the buffer
+    m_selectedNodes.clear();
+    glm::vec2 viewportSize(static_cast<float>(extent.width), static_cast<float>(extent.height));
+    m_octree.selectNodes(viewProjection, viewportSize, m_pointBudget, m_minNodePixels, m_selectedNodes,
+                         m_nodeVisibility.data());
+    if (m_paged) {
+        makeResident(m_selectedNodes);
+    }
+    m_drawnNodeCount = static_cast<uint32_t>(m_selectedNodes.size());
+
+    const std::vector<PointOctreeNode>& nodes = m_octree.getNodes();
+    std::sort(m_selectedNodes.begin(), m_selectedNodes.end(), [this](uint32_t a, uint32_t b) {
+        return m_residentFirst[a] < m_residentFirst[b];
+    });
+
+    bool sprites = isDrawingSprites();
+    m_drawnPointCount = 0;
+    m_drawCallCount = 0;
+    uint32_t rangeFirst = 0;
+    uint32_t rangeCount = 0;
+    for (uint32_t nodeIndex : m_selectedNodes) {
+        const PointOctreeNode& node = nodes[nodeIndex];
+        uint32_t first = m_residentFirst[nodeIndex];
+        if (rangeCount > 0 && rangeFirst + rangeCount == first) {
+            rangeCount += node.pointCount;
+            m_drawnPointCount += node.pointCount;
+            continue;
+        }
+        if (rangeCount > 0) {
+            drawRange(commandBuffer, rangeFirst, rangeCount, sprites);
+            m_drawCallCount++;
+        }
+        rangeFirst = first;
+        rangeCount = node.pointCount;
+        m_drawnPointCount += node.pointCount;
+    }
+    if (rangeCount > 0) {
+        drawRange(commandBuffer, rangeFirst, rangeCount, sprites);
+        m_drawCallCount++;
+    }
+}
+
+void PointCloudRenderer::drawIndirect(VkCommandBuffer commandBuffer) {
+    uint32_t nodeCount = static_cast<uint32_t>(m_octree.getNodes().size());
+    VkDeviceSize stride = sizeof(VkDrawIndirectCommand);
+
+    // Unused commands were zeroed before culling and draw nothing
+    m_drawCallCount = 0;
+    for (uint32_t first = 0; first < nodeCount; first += m_maxDrawIndirectCount) {
+        uint32_t count = (std::min)(m_maxDrawIndirectCount, nodeCount - first);
+        vkCmdDrawIndirect(commandBuffer, m_drawBuffer, CULL_COUNTERS_SIZE + stride * first, count,
+                          static_cast<uint32_t>(stride));
+        m_drawCallCount++;
+    }
+}
+
+void PointCloudRenderer::cull(VkCommandBuffer commandBuffer) {
+    if (!m_initialized || !m_hasData || !useIndirectDraws()) {
+        return;
+    }
+
+    uint32_t nodeCount = static_cast<uint32_t>(m_octree.getNodes().size());
+    uint32_t frameSlot = static_cast<uint32_t>(m_vulkanContext->getCurrentFrame() % CULL_FRAME_SLOTS);
+
+    // This frame slot's fence has been waited on, so its counters hold the
+    // results of the last frame that used it
+    m_visibleNodeCount = m_drawCounters[frameSlot * 2];
+    m_drawnNodeCount = m_visibleNodeCount;
+    m_drawnPointCount = m_drawCounters[frameSlot * 2 + 1];
+
+    // Waiting for the previous draws and publishing the results to the indirect
+    // draw and the host is left to the render graph (see getCullBuffer())
+    vkCmdFillBuffer(commandBuffer, m_drawBuffer, sizeof(uint32_t) * 2 * frameSlot, sizeof(uint32_t) * 2, 0);
+    vkCmdFillBuffer(commandBuffer, m_drawBuffer, CULL_COUNTERS_SIZE, sizeof(VkDrawIndirectCommand) * nodeCount, 0);
+    vkCmdFillBuffer(commandBuffer, m_drawBuffer, m_cullEmittedOffset, sizeof(uint32_t) * nodeCount, 0);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    const glm::mat4& viewProjection = m_camera->getViewProjectionMatrix();
+    VkExtent2D extent = m_vulkanContext->getSwapchainExtent();
+    Frustum frustum = Frustum::fromViewProjection(viewProjection);
+
+    GpuCullPushConstants pushConstants{};
+    for (int i = 0; i < 6; i++) {
+        pushConstants.planes[i] = frustum.planes[i];
+    }
+    float pixelsPerUnit = PointOctree::pixelsPerUnit(viewProjection,
+        glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height)));
+    pushConstants.minRadiusW = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3],
+                                         viewProjection[3][3]) * (m_minNodePixels / pixelsPerUnit);
+    pushConstants.frameSlot = frameSlot;
+    pushConstants.pointBudget = m_pointBudget;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                      isDrawingSprites() ? m_cullSpritePipeline : m_cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout,
+                            0, 1, &m_cullDescriptorSet, 0, nullptr);
+
+    // One dispatch per octree level, coarsest first; each level reads the
+    // emitted flags and the budget counter the previous level wrote
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    for (size_t level = 0; level + 1 < m_cullLevelStarts.size(); level++) {
+        if (level > 0) {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+        pushConstants.levelFirst = m_cullLevelStarts[level];
+        pushConstants.levelCount = m_cullLevelStarts[level + 1] - m_cullLevelStarts[level];
+        vkCmdPushConstants(commandBuffer, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, sizeof(pushConstants), &pushConstants);
+        vkCmdDispatch(commandBuffer, (pushConstants.levelCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+    }
+}
+
+void PointCloudRenderer::createColumnResources() {
+    VkDevice device = m_vulkanContext->getDevice();
+    m_spriteVertexShaderModule = ShaderCompiler::loadAndCreateModule(device, "shaders/pointsprite.vert.spv");
+    m_spriteFragmentShaderModule = ShaderCompiler::loadAndCreateModule(device, "shaders/pointsprite.frag.spv");
+    // A module of its own, so a hot reload of pointcloud.frag never retires it
+    m_pullVertexShaderModule = ShaderCompiler::loadAndCreateModule(device, "shaders/pointpull.vert.spv");
+    m_pullFragmentShaderModule = ShaderCompiler::loadAndCreateModule(device, "shaders/pointcloud.frag.spv");
+
+    // One storage buffer per point column
+    std::array<VkDescriptorSetLayoutBinding, POINT_COLUMN_COUNT> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_columnDescriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create point column descriptor set layout!");
+    }
+
+    createColumnDescriptorSet();
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(ColumnPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_columnDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_columnPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create point column pipeline layout!");
+    }
+
+    // Every shape with and without labels up front, like the point list pipelines
+    PipelineBuilder& builder = m_vulkanContext->getPipelineBuilder();
+    buildColumnPipelines(true, m_spriteVertexShaderModule, m_spriteFragmentShaderModule);
+    buildColumnPipelines(false, m_pullVertexShaderModule, m_pullFragmentShaderModule);
+    m_spritePipeline = builder.getPipeline(makeSpritePipelineKey(m_spriteVertexShaderModule, m_spriteFragmentShaderModule, m_pointShape, m_hasLabels));
+    m_pullPipeline = builder.getPipeline(makePullPipelineKey(m_pullVertexShaderModule, m_pullFragmentShaderModule, m_pointShape, m_hasLabels));
+}
+
+void PointCloudRenderer::destroyColumnResources() {
+    VkDevice device = m_vulkanContext->getDevice();
+    if (m_spriteVertexShaderModule != VK_NULL_HANDLE) {
+        m_vulkanContext->getPipelineBuilder().destroyPipelines(m_spriteVertexShaderModule);
+    }
+    if (m_pullVertexShaderModule != VK_NULL_HANDLE) {
+        m_vulkanContext->getPipelineBuilder().destroyPipelines(m_pullVertexShaderModule);
+    }
+    m_spritePipeline = VK_NULL_HANDLE;
+    m_pullPipeline = VK_NULL_HANDLE;
+    if (m_columnPipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, m_columnPipelineLayout, nullptr);
+        m_columnPipelineLayout = VK_NULL_HANDLE;
+    }
+    if (m_columnDescriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, m_columnDescriptorPool, nullptr);
+        m_columnDescriptorPool = VK_NULL_HANDLE;
+        m_columnDescriptorSet = VK_NULL_HANDLE;
+    }
+    if (m_columnDescriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, m_columnDescriptorSetLayout, nullptr);
+        m_columnDescriptorSetLayout = VK_NULL_HANDLE;
+    }
+    if (m_spriteFragmentShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, m_spriteFragmentShaderModule, nullptr);
+        m_spriteFragmentShaderModule = VK_NULL_HANDLE;
+    }
+    if (m_spriteVertexShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, m_spriteVertexShaderModule, nullptr);
+        m_spriteVertexShaderModule = VK_NULL_HANDLE;
+    }
+    if (m_pullFragmentShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, m_pullFragmentShaderModule, nullptr);
+        m_pullFragmentShaderModule = VK_NULL_HANDLE;
+    }
+    if (m_pullVertexShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, m_pullVertexShaderModule, nullptr);
+        m_pullVertexShaderModule = VK_NULL_HANDLE;
+    }
+    m_spritesEnabled = false;
+    m_vertexPulling = false;
+    m_columnsBound = false;
+}
+
+void PointCloudRenderer::createColumnDescriptorSet() {
+    // A pool of its own per point buffer, so a retired set goes with its pool
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = POINT_COLUMN_COUNT;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if (vkCreateDescriptorPool(m_vulkanContext->getDevice(), &poolInfo, nullptr, &m_columnDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create point column descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_columnDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_columnDescriptorSetLayout;
+    if (vkAllocateDescriptorSets(m_vulkanContext->getDevice(), &allocInfo, &m_columnDescriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate point column descriptor set!");
+    }
+}
+
+void PointCloudRenderer::updateColumnDescriptorSet() {
+    // The set was allocated with the buffer, so no frame has bound it yet
+    m_columnsBound = false;
+    if (m_columnDescriptorSet == VK_NULL_HANDLE || m_vertexBuffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    std::array<VkDescriptorBufferInfo, POINT_COLUMN_COUNT> bufferInfos{};
+    std::array<VkWriteDescriptorSet, POINT_COLUMN_COUNT> writes{};
+    for (uint32_t column = 0; column < POINT_COLUMN_COUNT; column++) {
+        VkDeviceSize columnSize = POINT_COLUMN_STRIDES[column] * m_poolCapacity;
+        if (columnSize > m_maxStorageRange) {
+            Logger::warn("Point column of {} MB exceeds the storage buffer range, drawing point lists",
+                         columnSize / (1024 * 1024));
+            return;
+        }
+        bufferInfos[column].buffer = m_vertexBuffer;
+        bufferInfos[column].offset = m_columnOffsets[column];
+        bufferInfos[column].range = columnSize;
+        // Every binding needs a valid range; without labels the shaders never
+        // read the label binding, so it aliases the position column
+        if (column == POINT_COLUMN_LABEL && !m_hasLabels) {
+            bufferInfos[column].offset = m_columnOffsets[POINT_COLUMN_POSITION];
+            bufferInfos[column].range = POINT_COLUMN_STRIDES[POINT_COLUMN_POSITION] * m_poolCapacity;
+        }
+
+        writes[column].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[column].dstSet = m_columnDescriptorSet;
+        writes[column].dstBinding = column;
+        writes[column].descriptorCount = 1;
+        writes[column].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[column].pBufferInfo = &bufferInfos[column];
+    }
+    vkUpdateDescriptorSets(m_vulkanContext->getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    m_columnsBound = true;
+}
+
+void PointCloudRenderer::createTimestampQueries() {
+    // Timestamps are optional: without them no GPU draw time is reported
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanContext->getPhysicalDevice(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanContext->getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+    uint32_t graphicsFamily = m_vulkanContext->getGraphicsQueueFamily();
+    if (graphicsFamily >= queueFamilyCount || queueFamilies[graphicsFamily].timestampValidBits == 0 ||
+        m_timestampPeriodNs <= 0.0) {
+        Logger::info("GPU timestamps unsupported, point draw time is not measured");
+        return;
+    }
+
+    uint32_t frameCount = m_vulkanContext->getFrameCount();
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = frameCount * 2;
+    if (vkCreateQueryPool(m_vulkanContext->getDevice(), &queryPoolInfo, nullptr, &m_timestampPool) != VK_SUCCESS) {
+        Logger::warn("Failed to create point timestamp query pool");
+        m_timestampPool = VK_NULL_HANDLE;
+        return;
+    }
+    m_timestampsWritten.assign(frameCount, 0);
+}
+
+void PointCloudRenderer::createCullPipeline() {
+    VkDevice device = m_vulkanContext->getDevice();
+
+    // Without multiDrawIndirect every node would cost a draw call of its own,
+    // more than the merged ranges drawCulled() records
+    if (!m_vulkanContext->getEnabledFeatures().multiDrawIndirect) {
+        throw std::runtime_error("multiDrawIndirect is not supported!");
+    }
+
+    // The culling pass runs on the graphics queue
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanContext->getPhysicalDevice(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanContext->getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+    uint32_t graphicsFamily = m_vulkanContext->getGraphicsQueueFamily();
+    if (graphicsFamily >= queueFamilyCount || !(queueFamilies[graphicsFamily].queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+        throw std::runtime_error("Graphics queue does not support compute!");
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_vulkanContext->getPhysicalDevice(), &properties);
+    m_maxDrawIndirectCount = (std::max)(properties.limits.maxDrawIndirectCount, 1u);
+
+    m_cullShaderModule = ShaderCompiler::loadAndCreateModule(device, "shaders/pointcull.comp.spv");
+
+    // Nodes, draw commands, emitted flags
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_cullDescriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create point cull descriptor set layout!");
+    }
+
+    createCullDescriptorSet();
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(GpuCullPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_cullDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_cullPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create point cull pipeline layout!");
+    }
+
+    // Two variants: point list draws and instanced-quad draws (constant_id 0)
+    VkBool32 instancedQuads[2] = {VK_FALSE, VK_TRUE};
+    VkPipeline* pipelines[2] = {&m_cullPipeline, &m_cullSpritePipeline};
+    for (uint32_t i = 0; i < 2; i++) {
+        VkSpecializationMapEntry specializationEntry{0, 0, sizeof(VkBool32)};
+        VkSpecializationInfo specializationInfo{};
+        specializationInfo.mapEntryCount = 1;
+        specializationInfo.pMapEntries = &specializationEntry;
+        specializationInfo.dataSize = sizeof(VkBool32);
+        specializationInfo.pData = &instancedQuads[i];
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = m_cullShaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.stage.pSpecializationInfo = &specializationInfo;
+        pipelineInfo.layout = m_cullPipelineLayout;
+        if (vkCreateComputePipelines(device, m_vulkanContext->getPipelineCache(), 1, &pipelineInfo, nullptr, pipelines[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create point cull compute pipeline!");
+        }
+    }
+
+    Logger::info("PointCloudRenderer GPU culling enabled (max draws per indirect call: {})", m_maxDrawIndirectCount);
+}
+
+void PointCloudRenderer::destroyCullPipeline() {
+    VkDevice device = m_vulkanContext->getDevice();
+    if (m_cullPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, m_cullPipeline, nullptr);
+        m_cullPipeline = VK_NULL_HANDLE;
+    }
+    if (m_cullSpritePipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, m_cullSpritePipeline, nullptr);
+        m_cullSpritePipeline = VK_NULL_HANDLE;
+    }
+    if (m_cullPipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, m_cullPipelineLayout, nullptr);
+        m_cullPipelineLayout = VK_NULL_HANDLE;
+    }
+    if (m_cullDescriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, m_cullDescriptorPool, nullptr);
+        m_cullDescriptorPool = VK_NULL_HANDLE;
+        m_cullDescriptorSet = VK_NULL_HANDLE;
+    }
+    if (m_cullDescriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, m_cullDescriptorSetLayout, nullptr);
+        m_cullDescriptorSetLayout = VK_NULL_HANDLE;
+    }
+    if (m_cullShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, m_cullShaderModule, nullptr);
+        m_cullShaderModule = VK_NULL_HANDLE;
+    }
+    m_gpuCulling = false;
+}
+
+void PointCloudRenderer::createCullDescriptorSet() {
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 3;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if (vkCreateDescriptorPool(m_vulkanContext->getDevice(), &poolInfo, nullptr, &m_cullDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create point cull descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_cullDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_cullDescriptorSetLayout;
+    if (vkAllocateDescriptorSets(m_vulkanContext->getDevice(), &allocInfo, &m_cullDescriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate point cull descriptor set!");
+    }
+}
+
+void PointCloudRenderer::createCullBuffers() {
+    VkDevice device = m_vulkanContext->getDevice();
+    const std::vector<PointOctreeNode>& nodes = m_octree.getNodes();
+    if (nodes.empty()) return;
+
+    // Breadth-first order, so every octree level is a contiguous range that
+    // cull() dispatches after the levels above it
+    std::vector<uint32_t> levelOrder;
+    std::vector<uint32_t> parents;
+    levelOrder.reserve(nodes.size());
+    parents.reserve(nodes.size());
+    levelOrder.push_back(0);
+    parents.push_back(CULL_NO_PARENT);
+    m_cullLevelStarts.assign(1, 0);
+    for (size_t levelBegin = 0; levelBegin < levelOrder.size();) {
+        size_t levelEnd = levelOrder.size();
+        for (size_t i = levelBegin; i < levelEnd; i++) {
+            const PointOctreeNode& node = nodes[levelOrder[i]];
+            for (uint32_t c = 0; c < node.childCount; c++) {
+                levelOrder.push_back(node.firstChild + c);
+                parents.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        m_cullLevelStarts.push_back(static_cast<uint32_t>(levelEnd));
+        levelBegin = levelEnd;
+    }
+
+    // Node bounds and point ranges
+    VkDeviceSize nodeBufferSize = sizeof(GpuCullNode) * nodes.size();
+    GpuAllocator& allocator = m_vulkanContext->getAllocator();
+    allocator.createBuffer(nodeBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                           m_nodeBuffer, m_nodeBufferMemory, GpuMemoryCategory::Points);
+
+    GpuCullNode* gpuNodes = static_cast<GpuCullNode*>(m_nodeBufferMemory.mapped);
+    for (size_t i = 0; i < levelOrder.size(); i++) {
+        const PointOctreeNode& node = nodes[levelOrder[i]];
+        GpuCullNode& gpuNode = gpuNodes[i];
+        for (int axis = 0; axis < 3; axis++) {
+            gpuNode.boundsMin[axis] = node.boundsMin[axis];
+            gpuNode.boundsMax[axis] = node.boundsMax[axis];
+        }
+        gpuNode.boundsMin[3] = 0.0f;
+        gpuNode.boundsMax[3] = 0.0f;
+        gpuNode.firstPoint = node.firstPoint;
+        gpuNode.pointCount = node.pointCount;
+        gpuNode.parent = parents[i];
+        gpuNode.pad = 0;
+    }
+
+    // Per-slot counters, one draw command per node, then one emitted flag per
+    // node at an offset a storage buffer descriptor can start at
+    VkDeviceSize commandsSize = CULL_COUNTERS_SIZE + sizeof(VkDrawIndirectCommand) * nodes.size();
+    m_cullEmittedOffset = (commandsSize + m_storageAlignment - 1) / m_storageAlignment * m_storageAlignment;
+    VkDeviceSize drawBufferSize = m_cullEmittedOffset + sizeof(uint32_t) * nodes.size();
+    allocator.createBuffer(drawBufferSize,
+                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                           m_drawBuffer, m_drawBufferMemory, GpuMemoryCategory::Points);
+
+    memset(m_drawBufferMemory.mapped, 0, static_cast<size_t>(drawBufferSize));
+    m_drawCounters = static_cast<const uint32_t*>(m_drawBufferMemory.mapped);
+
+    std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+    bufferInfos[0].buffer = m_nodeBuffer;
+    bufferInfos[0].offset = 0;
+    bufferInfos[0].range = VK_WHOLE_SIZE;
+    bufferInfos[1].buffer = m_drawBuffer;
+    bufferInfos[1].offset = 0;
+    bufferInfos[1].range = commandsSize;
+    bufferInfos[2].buffer = m_drawBuffer;
+    bufferInfos[2].offset = m_cullEmittedOffset;
+    bufferInfos[2].range = VK_WHOLE_SIZE;
+
+    std::array<VkWriteDescriptorSet, 3> writes{};
+    for (uint32_t i = 0; i < writes.size(); i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = m_cullDescriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void PointCloudRenderer::destroyCullBuffers() {
+    GpuAllocator& allocator = m_vulkanContext->getAllocator();
+    m_drawCounters = nullptr;
+    m_cullEmittedOffset = 0;
+    m_cullLevelStarts.clear();
+    allocator.destroyBuffer(m_drawBuffer, m_drawBufferMemory);
+    allocator.destroyBuffer(m_nodeBuffer, m_nodeBufferMemory);
 }
 
 void PointCloudRenderer::cleanup() {
-    if (m_graphicsPipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(m_vulkanContext->getDevice(), m_graphicsPipeline, nullptr);
-        m_graphicsPipeline = VK_NULL_HANDLE;
+    destroyCullPipeline();
+    destroyColumnResources();
+    if (m_timestampPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(m_vulkanContext->getDevice(), m_timestampPool, nullptr);
+        m_timestampPool = VK_NULL_HANDLE;
+    }
+    // The pipeline belongs to the pipeline builder and goes with the shader modules
+    if (m_vertexShaderModule != VK_NULL_HANDLE) {
+        m_vulkanContext->getPipelineBuilder().destroyPipelines(m_vertexShaderModule);
     }
+    m_graphicsPipeline = VK_NULL_HANDLE;
     if (m_pipelineLayout != VK_NULL_HANDLE) {
         vkDestroyPipelineLayout(m_vulkanContext->getDevice(), m_pipelineLayout, nullptr);
         m_pipelineLayout = VK_NULL_HANDLE;
@@ -334,14 +1664,7 @@ void PointCloudRenderer::cleanup() {
         vkDestroyShaderModule(m_vulkanContext->getDevice(), m_vertexShaderModule, nullptr);
         m_vertexShaderModule = VK_NULL_HANDLE;
     }
-    if (m_vertexBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(m_vulkanContext->getDevice(), m_vertexBuffer, nullptr);
-        m_vertexBuffer = VK_NULL_HANDLE;
-    }
-    if (m_vertexBufferMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(m_vulkanContext->getDevice(), m_vertexBufferMemory, nullptr);
-        m_vertexBufferMemory = VK_NULL_HANDLE;
-    }
+    destroyVertexBuffer();
     m_initialized = false;
     m_hasData = false;
 }
@@ -3,49 +3,319 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <glm/glm.hpp>
+#include "PointOctree.h"
+#include "GpuAllocator.h"
+#include "PipelineBuilder.h"
+#include "ShaderHotReloader.h"
 
 class VulkanContext;
 class Camera;
 class PluginContext;
 
-struct PointVertex {
-    glm::vec3 position;
-    glm::vec3 color;
-    float size;
+// Point attributes are stored on the GPU as separate columns (SoA) in one buffer,
+// matching the point cache layout so cached columns can be copied verbatim
+enum PointColumn : uint32_t {
+    POINT_COLUMN_POSITION = 0,  // vec3
+    POINT_COLUMN_COLOR,         // vec3
+    POINT_COLUMN_SIZE,          // float
+    POINT_COLUMN_LABEL,         // uint, only allocated when the points have labels
+    POINT_COLUMN_COUNT
 };
 
-class PointCloudRenderer {
+// Columns fed to pointcloud.vert as vertex attributes; the storage buffer
+// paths (sprites, vertex pulling) read every column
+constexpr uint32_t POINT_ATTRIBUTE_COLUMN_COUNT = POINT_COLUMN_LABEL;
+
+// Fragment shape of the points, a specialization constant of pointcloud.frag.
+// Every shape has its own pipeline, built once at init
+enum class PointShape : uint32_t {
+    Square = 0,     // No discard, keeps early depth testing; cheapest for huge clouds
+    Circle,         // Discards outside the disc
+    Smooth,         // Disc with an antialiased, alpha blended edge
+    Gaussian,       // Alpha blended gaussian splat without depth writes
+    Count
+};
+
+class PointCloudRenderer : public ShaderReloadTarget {
 public:
     PointCloudRenderer(VulkanContext* vulkanContext, Camera* camera);
-    ~PointCloudRenderer();
+    ~PointCloudRenderer() override;
 
     bool init();
     void updatePoints(PluginContext* pluginContext);
+    // Record the GPU culling pass; must be called outside of a render pass
+    // before draw() when GPU culling is enabled. The caller synchronizes the
+    // cull buffer: the pass writes it in the transfer and compute stages, the
+    // draw reads it as indirect commands and the host reads its counters
+    void cull(VkCommandBuffer commandBuffer);
     void draw(VkCommandBuffer commandBuffer);
+    // Collect the last GPU draw time of the current frame slot and reset its
+    // timestamp queries; must be called outside of a render pass before draw()
+    void resetTimestamps(VkCommandBuffer commandBuffer);
     void cleanup();
 
+    // ShaderReloadTarget: the point vertex/fragment shaders; the cull shader is not reloaded
+    VkPipeline buildPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader) override;
+    void replaceShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkPipeline pipeline) override;
+    // Reload targets of the sprite (pointsprite.vert/.frag) and vertex-pulling
+    // (pointpull.vert, pointcloud.frag) programs; null when the point columns
+    // cannot be bound as storage buffers
+    ShaderReloadTarget* getSpriteReloadTarget();
+    ShaderReloadTarget* getPullReloadTarget();
+
+    bool isGpuCullingEnabled() const { return m_gpuCulling; }
+    // Indirect draw commands and counters written by cull(); VK_NULL_HANDLE without GPU culling
+    VkBuffer getCullBuffer() const { return m_drawBuffer; }
+
+    // LOD settings
+    void setPointBudget(uint32_t budget) { m_pointBudget = budget; }
+    void setMinNodePixels(float pixels) { m_minNodePixels = pixels; }
+    uint32_t getPointBudget() const { return m_pointBudget; }
+    float getMinNodePixels() const { return m_minNodePixels; }
+    // Points a paged pool uploads per frame; the rest of the view fills in over
+    // the next frames. UINT32_MAX makes every frame complete (batch rendering)
+    void setUploadBudget(uint32_t points) { m_uploadBudget = points; }
+    uint32_t getUploadBudget() const { return m_uploadBudget; }
+
+    // Point shape (config point_shape: square, circle, smooth or gaussian)
+    void setPointShape(PointShape shape);
+    PointShape getPointShape() const { return m_pointShape; }
+    static const char* getPointShapeName(PointShape shape);
+
+    // Point sprites: draw every point as an instanced quad pulling its
+    // attributes from storage buffers, so sizes are not clamped to the
+    // device's point size range (config point_sprites: auto, on or off;
+    // auto uses sprites when the range ends below 64 pixels)
+    // Switching paths restarts the average GPU draw time
+    void setSpritesEnabled(bool enabled);
+    bool isSpritesEnabled() const { return m_spritesEnabled; }
+    // Sprites are enabled and usable for the current points
+    bool isDrawingSprites() const;
+    float getMaxPointSize() const { return m_maxPointSize; }
+
+    // Vertex pulling: draw point lists with pointpull.vert, which reads the
+    // columns as storage buffers by gl_VertexIndex instead of vertex
+    // attributes (config point_vertex_pulling). Like sprites it shows the
+    // label column; sprites take precedence when both are enabled
+    void setVertexPulling(bool enabled);
+    bool isVertexPulling() const { return m_vertexPulling; }
+    bool isPullingVertices() const;
+    // "sprites", "pulled" or "points"
+    const char* getDrawPathName() const;
+    bool hasLabels() const { return m_hasLabels; }
+
+    // GPU time of the point draw: the last measured frame and the average of
+    // all measured frames; 0 without timestamp support
+    double getGpuDrawTimeMs() const { return m_gpuDrawTimeMs; }
+    double getAverageGpuDrawTimeMs() const;
+
+    // Statistics of the last draw
+    uint32_t getPointCount() const { return m_pointCount; }
+    uint32_t getDrawnPointCount() const { return m_drawnPointCount; }
+    uint32_t getNodeCount() const { return static_cast<uint32_t>(m_octree.getNodes().size()); }
+    uint32_t getDrawnNodeCount() const { return m_drawnNodeCount; }
+    uint32_t getVisibleNodeCount() const { return m_visibleNodeCount; }
+    uint32_t getCulledNodeCount() const { return getNodeCount() - m_visibleNodeCount; }
+    uint32_t getDrawCallCount() const { return m_drawCallCount; }
+
+    // Residency: without enough memory for the whole cloud the vertex buffer
+    // becomes a pool of node ranges (see makeResident())
+    bool isPaged() const { return m_paged; }
+    uint32_t getResidentNodeCount() const { return m_residentNodeCount; }
+    uint32_t getEvictedNodeCount() const { return m_evictedNodeCount; }
+    uint32_t getPoolCapacity() const { return m_poolCapacity; }
+    // The last frame skipped selected nodes that later frames will upload
+    // (upload budget spent, or their pool space still in use by frames in
+    // flight); on-demand rendering keeps drawing until this clears
+    bool needsMoreFrames() const { return m_residencyPending; }
+
 private:
-    void createVertexBuffer();
+    // Forwards reloads of one storage buffer program to the renderer
+    class ColumnProgramReloadTarget : public ShaderReloadTarget {
+    public:
+        ColumnProgramReloadTarget(PointCloudRenderer* renderer, bool sprites) : m_renderer(renderer), m_sprites(sprites) {}
+        VkPipeline buildPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader) override;
+        void replaceShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkPipeline pipeline) override;
+
+    private:
+        PointCloudRenderer* m_renderer;
+        bool m_sprites;
+    };
+
+    void buildHierarchy(PluginContext* pluginContext);
+    void createVertexBuffer(PluginContext* pluginContext);
+    void destroyVertexBuffer();
+    // Defer destruction of the point buffers and their descriptor sets to the
+    // end of the current frame slot and allocate fresh descriptor sets
+    void retireVertexBuffer();
+    uint32_t choosePoolCapacity() const;
+    uint32_t getMinimumPoolCapacity() const;
+    // Copy points [first, first + count) in node order to pool offset 'dst'
+    void writePoints(uint32_t first, uint32_t count, uint32_t dst);
+    // Upload the selected nodes that are not resident, evicting the least
+    // recently drawn nodes for room; nodes that do not fit are dropped from 'selected'
+    void makeResident(std::vector<uint32_t>& selected);
+    bool allocatePoolRange(uint32_t count, uint32_t& first);
+    void releasePoolRange(uint32_t first, uint32_t count);
+    // Node holding a point in node order, or UINT32_MAX
+    uint32_t findNode(int64_t index) const;
+    // Pool offset of a point in node order, or -1 if its node is not resident;
+    // 'residentNode' receives the point's node when paged
+    int64_t findResidentPoint(int64_t index, uint32_t* residentNode = nullptr) const;
+    // Write point 'index' (node order) at pool offset 'location', highlighted or
+    // with its original values. 'staged' goes through the upload batcher, for
+    // points that frames in flight may read; otherwise it writes the mapping
+    void writeHighlight(int64_t index, int64_t location, bool highlighted, bool staged);
+    // Keep a node with a staged patch from being evicted this frame
+    void keepResident(uint32_t nodeIndex);
+    void updateSelection(PluginContext* pluginContext);
+    // Copy the labels of points [first, first + count) in node order to 'labels'
+    void gatherLabels(uint32_t first, uint32_t count, uint32_t* labels) const;
+    // Write them to pool offset 'dst' through the mapping, or stage them there
+    void writeLabels(uint32_t first, uint32_t count, uint32_t dst);
+    void uploadLabels(uint32_t first, uint32_t count, uint32_t dst);
+    // Stage the labels of the resident nodes holding changed labels
+    void updateLabels();
     void createShaderModules();
+    void createColumnResources();
+    void createColumnDescriptorSet();
+    void destroyColumnResources();
+    void updateColumnDescriptorSet();
+    void createTimestampQueries();
+    // Draw points [first, first + count) of the point buffer
+    void drawRange(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count, bool sprites);
+    bool useIndirectDraws() const;
     void createPipelineLayout();
     void createGraphicsPipeline();
+    PipelineKey makePipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader, PointShape shape) const;
+    PipelineKey makeSpritePipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader,
+                                      PointShape shape, bool labels) const;
+    PipelineKey makePullPipelineKey(VkShaderModule vertexShader, VkShaderModule fragmentShader,
+                                    PointShape shape, bool labels) const;
+    // Build every shape and label variant of the sprite or pulling program
+    void buildColumnPipelines(bool sprites, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+    // Swap in reloaded modules of the sprite or pulling program
+    void replaceColumnShaders(bool sprites, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+    // Pick the pipelines of the current shape and label column
+    void selectPipelines();
+    // Build the pipelines of every shape; returns the circle pipeline
+    VkPipeline buildShapePipelines(VkShaderModule vertexShader, VkShaderModule fragmentShader);
+    void createCullPipeline();
+    void destroyCullPipeline();
+    void createCullDescriptorSet();
+    void createCullBuffers();
+    void destroyCullBuffers();
+    void drawCulled(VkCommandBuffer commandBuffer);
+    void drawIndirect(VkCommandBuffer commandBuffer);
     
     VkShaderModule createShaderModule(const std::vector<char>& code);
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     
     VulkanContext* m_vulkanContext;
     Camera* m_camera;
     
-    std::vector<PointVertex> m_vertices;
+    uint32_t m_pointCount;
     
     VkBuffer m_vertexBuffer;
-    VkDeviceMemory m_vertexBufferMemory;
+    GpuAllocation m_vertexBufferMemory;
+    VkDeviceSize m_columnOffsets[POINT_COLUMN_COUNT];
+    void* m_mappedData;
+    
+    // LOD hierarchy; the vertex buffer holds points in node order
+    PointOctree m_octree;
+    std::vector<uint32_t> m_selectedNodes;
+    std::vector<uint8_t> m_nodeVisibility;
+    uint32_t m_pointBudget;
+    float m_minNodePixels;
+    uint32_t m_uploadBudget;
+    uint32_t m_drawnPointCount;
+    uint32_t m_visibleNodeCount;
+    uint32_t m_drawnNodeCount;
+    uint32_t m_drawCallCount;
+    
+    // GPU culling: a compute pass tests the nodes level by level and writes
+    // the survivors as indirect draw commands, so CPU work does not depend on
+    // the point count
+    bool m_gpuCulling;
+    VkShaderModule m_cullShaderModule;
+    VkDescriptorSetLayout m_cullDescriptorSetLayout;
+    VkDescriptorPool m_cullDescriptorPool;
+    VkDescriptorSet m_cullDescriptorSet;
+    VkPipelineLayout m_cullPipelineLayout;
+    VkPipeline m_cullPipeline;
+    VkPipeline m_cullSpritePipeline;    // Writes instanced-quad draws
+    VkBuffer m_nodeBuffer;
+    GpuAllocation m_nodeBufferMemory;
+    VkBuffer m_drawBuffer;
+    GpuAllocation m_drawBufferMemory;
+    const uint32_t* m_drawCounters;
+    VkDeviceSize m_cullEmittedOffset;
+    // First node of each octree level in the node buffer, plus the node count
+    std::vector<uint32_t> m_cullLevelStarts;
+    uint32_t m_maxDrawIndirectCount;
+    
+    // Residency. m_residentFirst[node] is the node's offset in the pool; without
+    // paging every node is resident at its firstPoint
+    struct PoolRange {
+        uint32_t first;
+        uint32_t count;
+    };
+    PluginContext* m_pointSource;
+    bool m_paged;
+    uint32_t m_poolCapacity;
+    uint64_t m_pointMemoryLimit;
+    std::vector<uint32_t> m_residentFirst;
+    std::vector<uint64_t> m_lastDrawnFrame;
+    // Nodes sorted by firstPoint, to find the node of a point
+    std::vector<uint32_t> m_nodesByFirstPoint;
+    // Free pool ranges sorted by offset, adjacent ranges merged
+    std::vector<PoolRange> m_poolFree;
+    std::vector<uint32_t> m_evictionCandidates;
+    // Nodes whose labels updateLabels() stages, kept to avoid reallocating
+    std::vector<uint8_t> m_labelNodeDirty;
+    std::vector<uint32_t> m_dirtyLabelNodes;
+    uint32_t m_residentNodeCount;
+    uint32_t m_evictedNodeCount;
+    bool m_residencyPending;
+
+    // Selection highlight (point index in node order); the values it replaced
+    // are read back from the point source
+    int64_t m_highlightIndex;
     
     VkShaderModule m_vertexShaderModule;
     VkShaderModule m_fragmentShaderModule;
     
     VkPipelineLayout m_pipelineLayout;
     VkPipeline m_graphicsPipeline;
+    PointShape m_pointShape;
+
+    // Point sprites and vertex pulling: the point buffer's columns are bound as storage buffers
+    bool m_spritesEnabled;
+    bool m_vertexPulling;
+    bool m_hasLabels;                   // The point buffer has a label column
+    bool m_columnsBound;                // Columns fit the storage buffer limits
+    float m_maxPointSize;
+    VkDeviceSize m_storageAlignment;
+    VkDeviceSize m_maxStorageRange;
+    VkShaderModule m_spriteVertexShaderModule;
+    VkShaderModule m_spriteFragmentShaderModule;
+    VkDescriptorSetLayout m_columnDescriptorSetLayout;
+    VkDescriptorPool m_columnDescriptorPool;
+    VkDescriptorSet m_columnDescriptorSet;
+    VkPipelineLayout m_columnPipelineLayout;
+    VkPipeline m_spritePipeline;
+    VkShaderModule m_pullVertexShaderModule;
+    VkShaderModule m_pullFragmentShaderModule;
+    VkPipeline m_pullPipeline;
+    ColumnProgramReloadTarget m_spriteReloadTarget;
+    ColumnProgramReloadTarget m_pullReloadTarget;
+
+    // Timestamps around the point draw, two queries per frame slot
+    VkQueryPool m_timestampPool;
+    double m_timestampPeriodNs;
+    std::vector<uint8_t> m_timestampsWritten;
+    double m_gpuDrawTimeMs;
+    double m_gpuDrawTimeTotalMs;
+    uint64_t m_gpuDrawTimeSamples;
     
     bool m_initialized;
     bool m_hasData;
@@ -0,0 +1,225 @@
+#include "PointOctree.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <queue>
+
+namespace {
+
+// Morton codes use 21 bits per axis, so the hierarchy is at most 21 levels deep
+constexpr uint32_t MORTON_BITS_PER_AXIS = 21;
+
+// Spread the low 21 bits of v so that there are two zero bits between each
+uint64_t expandBits(uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x1f00000000ffffULL;
+    v = (v | (v << 16)) & 0x1f0000ff0000ffULL;
+    v = (v | (v << 8)) & 0x100f00f00f00f00fULL;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ULL;
+    v = (v | (v << 2)) & 0x1249249249249249ULL;
+    return v;
+}
+
+} // namespace
+
+void PointOctree::clear() {
+    m_nodes.clear();
+    m_nodeBounds.clear();
+    m_order.clear();
+    m_inverseOrder.clear();
+    m_pointCount = 0;
+}
+
+void PointOctree::assign(std::vector<PointOctreeNode> nodes, size_t pointCount) {
+    clear();
+    m_nodes = std::move(nodes);
+    m_pointCount = pointCount;
+    updateNodeBounds();
+}
+
+void PointOctree::updateNodeBounds() {
+    m_nodeBounds.resize(m_nodes.size());
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        m_nodeBounds.set(i, m_nodes[i].boundsMin, m_nodes[i].boundsMax);
+    }
+}
+
+void PointOctree::build(const float* positions, size_t pointCount, uint32_t maxPointsPerNode) {
+    clear();
+    if (pointCount == 0) {
+        return;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    m_pointCount = pointCount;
+    m_maxPointsPerNode = maxPointsPerNode > 0 ? maxPointsPerNode : DEFAULT_MAX_POINTS_PER_NODE;
+
+    // Overall bounds for quantization
+    glm::vec3 boundsMin((std::numeric_limits<float>::max)());
+    glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i < pointCount; i++) {
+        glm::vec3 p(positions[i * 3 + 0], positions[i * 3 + 1], positions[i * 3 + 2]);
+        boundsMin = glm::min(boundsMin, p);
+        boundsMax = glm::max(boundsMax, p);
+    }
+
+    // Use a cube so that octants stay cubic at every level
+    glm::vec3 extent = boundsMax - boundsMin;
+    float cubeSize = (std::max)(extent.x, (std::max)(extent.y, extent.z));
+    float scale = cubeSize > 0.0f ? static_cast<float>((1u << MORTON_BITS_PER_AXIS) - 1) / cubeSize : 0.0f;
+
+    // Sort points along the Morton curve; every octree cell is then a contiguous range
+    std::vector<MortonEntry> entries(pointCount);
+    for (size_t i = 0; i < pointCount; i++) {
+        uint64_t qx = static_cast<uint64_t>((positions[i * 3 + 0] - boundsMin.x) * scale);
+        uint64_t qy = static_cast<uint64_t>((positions[i * 3 + 1] - boundsMin.y) * scale);
+        uint64_t qz = static_cast<uint64_t>((positions[i * 3 + 2] - boundsMin.z) * scale);
+        entries[i].code = expandBits(qx) | (expandBits(qy) << 1) | (expandBits(qz) << 2);
+        entries[i].index = static_cast<uint32_t>(i);
+    }
+    std::sort(entries.begin(), entries.end(), [](const MortonEntry& a, const MortonEntry& b) {
+        return a.code < b.code;
+    });
+
+    m_order.reserve(pointCount);
+    m_nodes.resize(1);
+    buildNode(0, entries, 0, entries.size(), 0, positions);
+    updateNodeBounds();
+
+    m_inverseOrder.resize(pointCount);
+    for (size_t i = 0; i < m_order.size(); i++) {
+        m_inverseOrder[m_order[i]] = static_cast<uint32_t>(i);
+    }
+
+    std::chrono::duration<float, std::milli> buildTime = std::chrono::steady_clock::now() - startTime;
+    Logger::info("PointOctree built: {} points, {} nodes in {:.1f} ms", pointCount, m_nodes.size(), buildTime.count());
+}
+
+void PointOctree::buildNode(uint32_t nodeIndex, std::vector<MortonEntry>& entries,
+                            size_t begin, size_t end, uint32_t depth, const float* positions) {
+    size_t count = end - begin;
+    size_t remainingEnd = begin;
+
+    m_nodes[nodeIndex].firstPoint = static_cast<uint32_t>(m_order.size());
+
+    if (count <= m_maxPointsPerNode || depth >= MORTON_BITS_PER_AXIS) {
+        // Leaf: the node keeps all of its points
+        for (size_t i = begin; i < end; i++) {
+            m_order.push_back(entries[i].index);
+        }
+    } else {
+        // Keep every n-th point along the Morton curve as the node's subsample and
+        // compact the rest (still sorted) to the front of the range for the children
+        size_t stride = (count + m_maxPointsPerNode - 1) / m_maxPointsPerNode;
+        for (size_t i = begin; i < end; i++) {
+            if ((i - begin) % stride == 0) {
+                m_order.push_back(entries[i].index);
+            } else {
+                entries[remainingEnd++] = entries[i];
+            }
+        }
+    }
+    m_nodes[nodeIndex].pointCount = static_cast<uint32_t>(m_order.size()) - m_nodes[nodeIndex].firstPoint;
+
+    // Tight bounds of the node's own points
+    glm::vec3 boundsMin((std::numeric_limits<float>::max)());
+    glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+    const PointOctreeNode& self = m_nodes[nodeIndex];
+    for (uint32_t i = self.firstPoint; i < self.firstPoint + self.pointCount; i++) {
+        const float* p = positions + static_cast<size_t>(m_order[i]) * 3;
+        boundsMin = glm::min(boundsMin, glm::vec3(p[0], p[1], p[2]));
+        boundsMax = glm::max(boundsMax, glm::vec3(p[0], p[1], p[2]));
+    }
+
+    // Split the remaining points by octant; ranges are contiguous because of the Morton order
+    uint32_t shift = 3 * (MORTON_BITS_PER_AXIS - 1 - depth);
+    size_t childBegin[8];
+    size_t childEnd[8];
+    uint32_t childCount = 0;
+    for (size_t i = begin; i < remainingEnd;) {
+        uint64_t octant = (entries[i].code >> shift) & 7;
+        size_t j = i + 1;
+        while (j < remainingEnd && ((entries[j].code >> shift) & 7) == octant) {
+            j++;
+        }
+        childBegin[childCount] = i;
+        childEnd[childCount] = j;
+        childCount++;
+        i = j;
+    }
+
+    uint32_t firstChild = static_cast<uint32_t>(m_nodes.size());
+    m_nodes[nodeIndex].firstChild = firstChild;
+    m_nodes[nodeIndex].childCount = childCount;
+    m_nodes.resize(m_nodes.size() + childCount);
+
+    for (uint32_t c = 0; c < childCount; c++) {
+        buildNode(firstChild + c, entries, childBegin[c], childEnd[c], depth + 1, positions);
+        boundsMin = glm::min(boundsMin, m_nodes[firstChild + c].boundsMin);
+        boundsMax = glm::max(boundsMax, m_nodes[firstChild + c].boundsMax);
+    }
+
+    m_nodes[nodeIndex].boundsMin = boundsMin;
+    m_nodes[nodeIndex].boundsMax = boundsMax;
+}
+
+float PointOctree::projectedSize(const PointOctreeNode& node, const glm::mat4& viewProjection,
+                                 const glm::vec2& viewportSize) {
+    glm::vec3 center = (node.boundsMin + node.boundsMax) * 0.5f;
+    float radius = glm::length(node.boundsMax - node.boundsMin) * 0.5f;
+
+    glm::vec4 clipCenter = viewProjection * glm::vec4(center, 1.0f);
+    if (clipCenter.w <= 1e-6f) {
+        // Camera is inside or in front of the node, treat it as covering the screen
+        return (std::numeric_limits<float>::max)();
+    }
+
+    return radius * pixelsPerUnit(viewProjection, viewportSize) / clipCenter.w;
+}
+
+float PointOctree::pixelsPerUnit(const glm::mat4& viewProjection, const glm::vec2& viewportSize) {
+    // Clip-space units per world unit along the screen axes (rows of the matrix)
+    float scaleX = glm::length(glm::vec3(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0]));
+    float scaleY = glm::length(glm::vec3(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1]));
+    return 0.5f * (std::max)(scaleX * viewportSize.x, scaleY * viewportSize.y);
+}
+
+void PointOctree::selectNodes(const glm::mat4& viewProjection, const glm::vec2& viewportSize,
+                              uint32_t pointBudget, float minNodePixels,
+                              std::vector<uint32_t>& selected,
+                              const uint8_t* visibility) const {
+    if (m_nodes.empty() || (visibility && !visibility[0])) {
+        return;
+    }
+
+    // Largest projected nodes are refined first
+    using Candidate = std::pair<float, uint32_t>;
+    std::priority_queue<Candidate> candidates;
+    candidates.push({ projectedSize(m_nodes[0], viewProjection, viewportSize), 0 });
+
+    uint32_t remaining = pointBudget;
+    while (!candidates.empty()) {
+        uint32_t nodeIndex = candidates.top().second;
+        candidates.pop();
+
+        const PointOctreeNode& node = m_nodes[nodeIndex];
+        if (node.pointCount > remaining) {
+            break;
+        }
+        remaining -= node.pointCount;
+        selected.push_back(nodeIndex);
+
+        for (uint32_t c = 0; c < node.childCount; c++) {
+            uint32_t childIndex = node.firstChild + c;
+            if (visibility && !visibility[childIndex]) {
+                continue;
+            }
+            float size = projectedSize(m_nodes[childIndex], viewProjection, viewportSize);
+            if (size >= minNodePixels) {
+                candidates.push({ size, childIndex });
+            }
+        }
+    }
+}
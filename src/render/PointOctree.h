@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+
+// A node of the LOD hierarchy. Each node owns a contiguous range of the
+// reordered point buffer holding a subsample of the points in its cell; the
+// remaining points are distributed over its children. Drawing a node together
+// with all its ancestors therefore draws every point in the node's cell at the
+// density of that level.
+struct PointOctreeNode {
+    glm::vec3 boundsMin;    // Tight bounds of all points in the subtree
+    glm::vec3 boundsMax;
+    uint32_t firstPoint;    // Range of this node's own points in the reordered buffer
+    uint32_t pointCount;
+    uint32_t firstChild;    // Children are stored contiguously in the node array
+    uint32_t childCount;
+};
+
+class PointOctree {
+public:
+    static constexpr uint32_t DEFAULT_MAX_POINTS_PER_NODE = 16384;
+
+    PointOctree() = default;
+
+    // Build the hierarchy from xyz-interleaved positions
+    void build(const float* positions, size_t pointCount,
+               uint32_t maxPointsPerNode = DEFAULT_MAX_POINTS_PER_NODE);
+
+    // Adopt an already built hierarchy (e.g. from a point cache) whose points
+    // are stored in node order
+    void assign(std::vector<PointOctreeNode> nodes, size_t pointCount);
+
+    void clear();
+    bool empty() const { return m_nodes.empty(); }
+
+    // Select nodes to draw, refining the largest nodes on screen first until
+    // the point budget is spent or nodes become smaller than minNodePixels.
+    // Nodes whose entry in 'visibility' is 0 are skipped together with their
+    // subtrees (pass nullptr to consider every node visible).
+    // Selected node indices are appended to 'selected'.
+    void selectNodes(const glm::mat4& viewProjection, const glm::vec2& viewportSize,
+                     uint32_t pointBudget, float minNodePixels,
+                     std::vector<uint32_t>& selected,
+                     const uint8_t* visibility = nullptr) const;
+
+    // Projected radius in pixels of a node's bounding sphere
+    static float projectedSize(const PointOctreeNode& node, const glm::mat4& viewProjection,
+                               const glm::vec2& viewportSize);
+    // Pixels per world unit at clip w = 1, used by projectedSize
+    static float pixelsPerUnit(const glm::mat4& viewProjection, const glm::vec2& viewportSize);
+
+    const std::vector<PointOctreeNode>& getNodes() const { return m_nodes; }
+    // Node bounds laid out for batch frustum culling
+    const AabbArray& getNodeBounds() const { return m_nodeBounds; }
+
+    // Reordered index -> original index. Empty when the hierarchy was assigned,
+    // in which case points are already stored in node order.
+    const std::vector<uint32_t>& getOrder() const { return m_order; }
+    // Original index -> reordered index (same emptiness rule as getOrder)
+    const std::vector<uint32_t>& getInverseOrder() const { return m_inverseOrder; }
+
+    size_t getPointCount() const { return m_pointCount; }
+
+private:
+    struct MortonEntry {
+        uint64_t code;
+        uint32_t index;
+    };
+
+    void buildNode(uint32_t nodeIndex, std::vector<MortonEntry>& entries,
+                   size_t begin, size_t end, uint32_t depth, const float* positions);
+    void updateNodeBounds();
+
+    std::vector<PointOctreeNode> m_nodes;
+    AabbArray m_nodeBounds;
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_inverseOrder;
+    size_t m_pointCount = 0;
+    uint32_t m_maxPointsPerNode = DEFAULT_MAX_POINTS_PER_NODE;
+};
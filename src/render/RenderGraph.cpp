@@ -0,0 +1,295 @@
+#include "RenderGraph.h"
+#include "VulkanContext.h"
+#include "Logger.h"
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr VkAccessFlags WRITE_ACCESS_MASK =
+    VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+    VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+} // namespace
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(ResourceHandle resource, VkPipelineStageFlags stages,
+                                                         VkAccessFlags access, VkImageLayout layout) {
+    m_graph->addUsage(m_pass, resource, ResourceState(stages, access, layout), VK_IMAGE_LAYOUT_UNDEFINED);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(ResourceHandle resource, VkPipelineStageFlags stages,
+                                                          VkAccessFlags access, VkImageLayout layout,
+                                                          VkImageLayout finalLayout) {
+    m_graph->addUsage(m_pass, resource, ResourceState(stages, access, layout), finalLayout);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::sideEffects() {
+    m_graph->m_passes[m_pass].sideEffects = true;
+    return *this;
+}
+
+RenderGraph::RenderGraph(VulkanContext* vulkanContext)
+    : m_vulkanContext(vulkanContext), m_culledPassCount(0), m_barrierCount(0) {}
+
+RenderGraph::~RenderGraph() {
+    cleanup();
+}
+
+bool RenderGraph::init() {
+    return true;
+}
+
+void RenderGraph::cleanup() {
+    reset();
+}
+
+void RenderGraph::reset() {
+    m_resources.clear();
+    m_passes.clear();
+}
+
+RenderGraph::ResourceHandle RenderGraph::importImage(const std::string& name, VkImage image,
+                                                     VkImageAspectFlags aspect, const ResourceState& initial) {
+    Resource resource;
+    resource.name = name;
+    resource.isImage = true;
+    resource.image = image;
+    resource.aspect = aspect;
+    resource.initial = initial;
+    m_resources.push_back(resource);
+    return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::importBuffer(const std::string& name, VkBuffer buffer,
+                                                      const ResourceState& initial) {
+    Resource resource;
+    resource.name = name;
+    resource.buffer = buffer;
+    resource.initial = initial;
+    m_resources.push_back(resource);
+    return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+void RenderGraph::exportResource(ResourceHandle resource, const ResourceState& final) {
+    if (resource >= m_resources.size()) {
+        throw std::runtime_error("Invalid render graph resource!");
+    }
+    m_resources[resource].exported = true;
+    m_resources[resource].final = final;
+}
+
+RenderGraph::PassBuilder RenderGraph::addPass(const std::string& name, ExecuteFunction execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+    return PassBuilder(this, static_cast<uint32_t>(m_passes.size() - 1));
+}
+
+void RenderGraph::addUsage(uint32_t pass, ResourceHandle resource, const ResourceState& state,
+                           VkImageLayout finalLayout) {
+    if (resource >= m_resources.size()) {
+        throw std::runtime_error("Invalid render graph resource!");
+    }
+
+    // Several uses of one resource in a pass are merged into one
+    for (auto& usage : m_passes[pass].usages) {
+        if (usage.resource != resource) {
+            continue;
+        }
+        if (state.layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+            if (usage.state.layout != VK_IMAGE_LAYOUT_UNDEFINED && usage.state.layout != state.layout) {
+                throw std::runtime_error("Conflicting layouts for " + m_resources[resource].name +
+                                         " in pass " + m_passes[pass].name);
+            }
+            usage.state.layout = state.layout;
+        }
+        if (finalLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+            usage.finalLayout = finalLayout;
+        }
+        usage.state.stages |= state.stages;
+        usage.state.access |= state.access;
+        return;
+    }
+
+    Usage usage;
+    usage.resource = resource;
+    usage.state = state;
+    usage.finalLayout = finalLayout;
+    m_passes[pass].usages.push_back(usage);
+}
+
+void RenderGraph::cullPasses() {
+    // Walk backwards from the exported resources; a pass is live if it writes
+    // something a live pass (or the frame's output) needs
+    std::vector<bool> needed(m_resources.size(), false);
+    for (size_t i = 0; i < m_resources.size(); i++) {
+        needed[i] = m_resources[i].exported;
+    }
+
+    m_culledPassCount = 0;
+    for (size_t i = m_passes.size(); i-- > 0;) {
+        Pass& pass = m_passes[i];
+        pass.live = pass.sideEffects;
+        for (const auto& usage : pass.usages) {
+            if ((usage.state.access & WRITE_ACCESS_MASK) && needed[usage.resource]) {
+                pass.live = true;
+            }
+        }
+        if (!pass.live) {
+            m_culledPassCount++;
+            Logger::debug("  Render graph: culled pass '{}'", pass.name);
+            continue;
+        }
+        for (const auto& usage : pass.usages) {
+            if (usage.state.access & ~WRITE_ACCESS_MASK) {
+                needed[usage.resource] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::transition(ResourceHandle resource, TrackedState& tracked, const ResourceState& state,
+                             VkImageLayout finalLayout, BarrierBatch& batch) {
+    const Resource& res = m_resources[resource];
+    VkPipelineStageFlags dstStages = state.stages != 0 ? state.stages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    VkAccessFlags writeAccess = state.access & WRITE_ACCESS_MASK;
+    VkAccessFlags readAccess = state.access & ~WRITE_ACCESS_MASK;
+    bool layoutChange = res.isImage && state.layout != VK_IMAGE_LAYOUT_UNDEFINED && state.layout != tracked.layout;
+
+    bool needBarrier = false;
+    VkPipelineStageFlags srcStages = 0;
+    VkAccessFlags srcAccess = 0;
+    if (layoutChange || writeAccess) {
+        // Writes and layout transitions wait for every earlier reader and writer
+        srcStages = tracked.writeStages | tracked.readStages;
+        srcAccess = tracked.writeAccess;
+        needBarrier = layoutChange || srcStages != 0;
+    } else if (readAccess && tracked.writeStages != 0 &&
+               ((readAccess & ~tracked.visibleAccess) || (dstStages & ~tracked.visibleStages))) {
+        // Read after write that has not been made visible to this stage yet
+        srcStages = tracked.writeStages;
+        srcAccess = tracked.writeAccess;
+        needBarrier = true;
+    }
+
+    if (needBarrier) {
+        batch.srcStages |= srcStages != 0 ? srcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        batch.dstStages |= dstStages;
+        if (layoutChange) {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = state.access;
+            barrier.oldLayout = tracked.layout;
+            barrier.newLayout = state.layout;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = res.image;
+            barrier.subresourceRange = { res.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+            batch.imageBarriers.push_back(barrier);
+        } else {
+            // Buffers and images that stay in their layout share one global barrier
+            batch.memoryBarrier.srcAccessMask |= srcAccess;
+            batch.memoryBarrier.dstAccessMask |= state.access;
+        }
+        m_barrierCount++;
+    }
+
+    if (writeAccess) {
+        tracked.writeStages = dstStages;
+        tracked.writeAccess = writeAccess;
+        tracked.readStages = 0;
+        tracked.visibleStages = 0;
+        tracked.visibleAccess = 0;
+    } else if (layoutChange) {
+        // The transition is a write that is visible to this reader only
+        tracked.writeStages = dstStages;
+        tracked.writeAccess = 0;
+        tracked.readStages = dstStages;
+        tracked.visibleStages = dstStages;
+        tracked.visibleAccess = readAccess;
+    } else {
+        tracked.readStages |= dstStages;
+        if (needBarrier) {
+            tracked.visibleStages |= dstStages;
+            tracked.visibleAccess |= readAccess;
+        }
+    }
+
+    if (layoutChange) {
+        tracked.layout = state.layout;
+    }
+    if (res.isImage && finalLayout != VK_IMAGE_LAYOUT_UNDEFINED && finalLayout != tracked.layout) {
+        // The pass transitions the image itself (render pass finalLayout)
+        tracked.layout = finalLayout;
+        tracked.writeStages |= dstStages;
+        tracked.visibleStages = 0;
+        tracked.visibleAccess = 0;
+    }
+}
+
+void RenderGraph::flushBarriers(VkCommandBuffer commandBuffer, BarrierBatch& batch) {
+    if (batch.srcStages == 0) {
+        return;
+    }
+    batch.memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    bool hasMemoryBarrier = batch.memoryBarrier.srcAccessMask != 0 || batch.memoryBarrier.dstAccessMask != 0;
+    vkCmdPipelineBarrier(commandBuffer, batch.srcStages, batch.dstStages, 0,
+                         hasMemoryBarrier ? 1 : 0, &batch.memoryBarrier,
+                         0, nullptr,
+                         static_cast<uint32_t>(batch.imageBarriers.size()), batch.imageBarriers.data());
+    batch = BarrierBatch();
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer) {
+    m_barrierCount = 0;
+    cullPasses();
+
+    std::vector<TrackedState> tracked(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); i++) {
+        const Resource& resource = m_resources[i];
+        if (resource.initial.access & WRITE_ACCESS_MASK) {
+            tracked[i].writeStages = resource.initial.stages;
+            tracked[i].writeAccess = resource.initial.access & WRITE_ACCESS_MASK;
+        } else {
+            tracked[i].readStages = resource.initial.stages;
+        }
+        tracked[i].layout = resource.initial.layout;
+    }
+
+    BarrierBatch batch;
+    for (const auto& pass : m_passes) {
+        if (!pass.live) {
+            continue;
+        }
+        for (const auto& usage : pass.usages) {
+            transition(usage.resource, tracked[usage.resource], usage.state, usage.finalLayout, batch);
+        }
+        flushBarriers(commandBuffer, batch);
+        pass.execute(commandBuffer);
+    }
+
+    // Hand the outputs over in the state their consumers expect
+    for (size_t i = 0; i < m_resources.size(); i++) {
+        if (m_resources[i].exported) {
+            transition(static_cast<ResourceHandle>(i), tracked[i], m_resources[i].final,
+                       VK_IMAGE_LAYOUT_UNDEFINED, batch);
+        }
+    }
+    flushBarriers(commandBuffer, batch);
+
+    Logger::debug("  Render graph: {} passes, {} culled, {} barriers",
+                  m_passes.size(), m_culledPassCount, m_barrierCount);
+}
+
+VkImage RenderGraph::getImage(ResourceHandle resource) const {
+    return resource < m_resources.size() ? m_resources[resource].image : VK_NULL_HANDLE;
+}
+
+VkBuffer RenderGraph::getBuffer(ResourceHandle resource) const {
+    return resource < m_resources.size() ? m_resources[resource].buffer : VK_NULL_HANDLE;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class VulkanContext;
+
+// Per-frame graph of the passes recorded into a frame's command buffer.
+// Passes declare which resources they read and write and in which pipeline
+// stage, access and image layout; the graph then
+//   - culls passes whose outputs are neither read by a later live pass nor
+//     exported out of the frame (unless the pass has side effects),
+//   - inserts the pipeline barriers and layout transitions between passes.
+//
+// The graph is rebuilt every frame: reset(), import resources, add
+// passes, then execute(). Passes run in the order they were added. A pass
+// that keeps the previous contents of a resource it writes (e.g. a render
+// pass with LOAD_OP_LOAD) must also declare a read of it.
+class RenderGraph {
+public:
+    using ResourceHandle = uint32_t;
+    using ExecuteFunction = std::function<void(VkCommandBuffer commandBuffer)>;
+
+    static constexpr ResourceHandle INVALID_RESOURCE = UINT32_MAX;
+
+    // One use of a resource. A layout of VK_IMAGE_LAYOUT_UNDEFINED keeps the
+    // image in whatever layout it is in (or discards it for a render pass
+    // attachment with initialLayout UNDEFINED)
+    struct ResourceState {
+        ResourceState(VkPipelineStageFlags stages = 0, VkAccessFlags access = 0,
+                      VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED)
+            : stages(stages), access(access), layout(layout) {}
+
+        VkPipelineStageFlags stages;
+        VkAccessFlags access;
+        VkImageLayout layout;
+    };
+
+    class PassBuilder {
+    public:
+        PassBuilder& read(ResourceHandle resource, VkPipelineStageFlags stages, VkAccessFlags access,
+                          VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+        // finalLayout is the layout the pass leaves the image in when it
+        // transitions it itself (render pass finalLayout)
+        PassBuilder& write(ResourceHandle resource, VkPipelineStageFlags stages, VkAccessFlags access,
+                           VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED,
+                           VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+        // Never cull the pass, e.g. when it writes something the graph does not track
+        PassBuilder& sideEffects();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph* graph, uint32_t pass) : m_graph(graph), m_pass(pass) {}
+
+        RenderGraph* m_graph;
+        uint32_t m_pass;
+    };
+
+    explicit RenderGraph(VulkanContext* vulkanContext);
+    ~RenderGraph();
+
+    bool init();
+    void cleanup();
+
+    // Start a new frame
+    void reset();
+
+    // Resources owned outside the graph; 'initial' is their last use before the frame
+    ResourceHandle importImage(const std::string& name, VkImage image, VkImageAspectFlags aspect,
+                               const ResourceState& initial = ResourceState());
+    ResourceHandle importBuffer(const std::string& name, VkBuffer buffer,
+                                const ResourceState& initial = ResourceState());
+    // Mark a resource as an output of the frame and transition it to 'final' at the end
+    void exportResource(ResourceHandle resource, const ResourceState& final);
+
+    PassBuilder addPass(const std::string& name, ExecuteFunction execute);
+
+    // Cull and record the live passes with their barriers
+    void execute(VkCommandBuffer commandBuffer);
+
+    // Physical resources; valid inside pass callbacks
+    VkImage getImage(ResourceHandle resource) const;
+    VkBuffer getBuffer(ResourceHandle resource) const;
+
+    // Statistics of the last execute()
+    uint32_t getPassCount() const { return static_cast<uint32_t>(m_passes.size()); }
+    uint32_t getCulledPassCount() const { return m_culledPassCount; }
+    uint32_t getBarrierCount() const { return m_barrierCount; }
+
+private:
+    struct Resource {
+        std::string name;
+        bool isImage = false;
+        bool exported = false;
+        VkImage image = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkImageAspectFlags aspect = 0;
+        ResourceState initial;
+        ResourceState final;
+    };
+
+    struct Usage {
+        ResourceHandle resource;
+        ResourceState state;
+        VkImageLayout finalLayout;
+    };
+
+    struct Pass {
+        std::string name;
+        ExecuteFunction execute;
+        std::vector<Usage> usages;
+        bool sideEffects = false;
+        bool live = false;
+    };
+
+    // Synchronization state of a resource while the frame is recorded
+    struct TrackedState {
+        VkPipelineStageFlags writeStages = 0;
+        VkAccessFlags writeAccess = 0;
+        VkPipelineStageFlags readStages = 0;
+        // Stages and accesses the last write has been made visible to
+        VkPipelineStageFlags visibleStages = 0;
+        VkAccessFlags visibleAccess = 0;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    // Barriers batched in front of one pass
+    struct BarrierBatch {
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        VkMemoryBarrier memoryBarrier{};
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+    };
+
+    void addUsage(uint32_t pass, ResourceHandle resource, const ResourceState& state, VkImageLayout finalLayout);
+    void cullPasses();
+    void transition(ResourceHandle resource, TrackedState& tracked, const ResourceState& state,
+                    VkImageLayout finalLayout, BarrierBatch& batch);
+    void flushBarriers(VkCommandBuffer commandBuffer, BarrierBatch& batch);
+
+    VulkanContext* m_vulkanContext;
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    uint32_t m_culledPassCount;
+    uint32_t m_barrierCount;
+};
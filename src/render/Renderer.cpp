@@ -5,17 +5,26 @@
 #include "GridRenderer.h"
 #include "PointCloudRenderer.h"
 #include "PluginContext.h"
+#include "FrameReadback.h"
+#include "ParallelRecorder.h"
+#include "CameraUniforms.h"
+#include "RenderGraph.h"
+#include "ShaderHotReloader.h"
+#include "ThreadPool.h"
 #include "Config.h"
 #include "Logger.h"
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_vulkan.h>
 #include <stdexcept>
+#include <chrono>
+#include <functional>
 #include <glm/gtc/matrix_transform.hpp>
 
 Renderer::Renderer(VulkanContext* vulkanContext, Camera* camera, UI* ui)
     : m_vulkanContext(vulkanContext), m_camera(camera), m_ui(ui),
-      m_pluginContext(nullptr), m_descriptorPool(VK_NULL_HANDLE) {}
+      m_pluginContext(nullptr), m_frameReadback(nullptr), m_descriptorPool(VK_NULL_HANDLE), m_lastImageIndex(0),
+      m_showGrid(false), m_showAxes(false), m_showDemoObject(false), m_cacheStaticCommands(true) {}
 
 Renderer::~Renderer() {
     cleanup();
@@ -62,34 +71,95 @@ bool Renderer::init() {
         
         Logger::debug("vkCreateDescriptorPool succeeded!");
 
-        // 初始化坐标系渲染器
-        m_coordinateRenderer = std::make_unique<CoordinateSystemRenderer>(m_vulkanContext, m_camera);
-        if (!m_coordinateRenderer->init()) {
-            Logger::error("Failed to initialize coordinate system renderer!");
+        // 初始化相机uniform缓冲区（网格、坐标系和演示物体共用）
+        m_cameraUniforms = std::make_unique<CameraUniforms>(m_vulkanContext, m_camera);
+        if (!m_cameraUniforms->init()) {
+            Logger::error("Failed to initialize camera uniforms!");
             cleanup();
             return false;
         }
-        
-        // 初始化演示物体渲染器
-        m_demoObjectRenderer = std::make_unique<DemoObjectRenderer>(m_vulkanContext, m_camera);
-        if (!m_demoObjectRenderer->init()) {
-            Logger::error("Failed to initialize demo object renderer!");
+
+        // 初始化场景渲染器。各渲染器独立加载着色器并创建管线（共享管线缓存），
+        // 默认在工作线程上并行执行以缩短启动时间
+        m_coordinateRenderer = std::make_unique<CoordinateSystemRenderer>(m_vulkanContext, m_camera,
+                                                                          m_cameraUniforms.get());
+        m_demoObjectRenderer = std::make_unique<DemoObjectRenderer>(m_vulkanContext, m_camera, m_cameraUniforms.get());
+        m_gridRenderer = std::make_unique<GridRenderer>(m_vulkanContext, m_camera, m_cameraUniforms.get());
+        m_pointCloudRenderer = std::make_unique<PointCloudRenderer>(m_vulkanContext, m_camera);
+
+        struct SceneRendererInit {
+            const char* name;
+            std::function<bool()> init;
+            bool succeeded;
+        };
+        std::vector<SceneRendererInit> sceneInits = {
+            { "coordinate system", [this]() { return m_coordinateRenderer->init(); }, false },
+            { "demo object", [this]() { return m_demoObjectRenderer->init(); }, false },
+            { "grid", [this]() { return m_gridRenderer->init(); }, false },
+            { "point cloud", [this]() { return m_pointCloudRenderer->init(); }, false }
+        };
+
+        bool parallelInit = config.getBool("parallel_pipeline_creation", true);
+        auto initStart = std::chrono::steady_clock::now();
+        if (parallelInit) {
+            ThreadPool initPool(sceneInits.size());
+            for (auto& sceneInit : sceneInits) {
+                initPool.submit([&sceneInit]() { sceneInit.succeeded = sceneInit.init(); });
+            }
+            initPool.wait();
+        } else {
+            for (auto& sceneInit : sceneInits) {
+                sceneInit.succeeded = sceneInit.init();
+            }
+        }
+        double initMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - initStart).count();
+        Logger::info("Scene renderers initialized in {:.1f} ms ({})", initMs, parallelInit ? "parallel" : "sequential");
+
+        for (const auto& sceneInit : sceneInits) {
+            if (!sceneInit.succeeded) {
+                Logger::error("Failed to initialize {} renderer!", sceneInit.name);
+                cleanup();
+                return false;
+            }
+        }
+
+        // 网格、坐标轴和演示物体默认不绘制
+        m_showGrid = config.getBool("show_grid", false);
+        m_showAxes = config.getBool("show_axes", false);
+        m_showDemoObject = config.getBool("show_demo_object", false);
+        m_cacheStaticCommands = config.getBool("cache_static_commands", true);
+
+        // 初始化并行命令录制
+        m_parallelRecorder = std::make_unique<ParallelRecorder>(m_vulkanContext);
+        if (!m_parallelRecorder->init()) {
+            Logger::error("Failed to initialize parallel recorder!");
             cleanup();
             return false;
         }
 
-        // 初始化网格渲染器
-        m_gridRenderer = std::make_unique<GridRenderer>(m_vulkanContext, m_camera);
-        if (!m_gridRenderer->init()) {
-            Logger::error("Failed to initialize grid renderer!");
+        // 初始化渲染图
+        m_renderGraph = std::make_unique<RenderGraph>(m_vulkanContext);
+        if (!m_renderGraph->init()) {
+            Logger::error("Failed to initialize render graph!");
             cleanup();
             return false;
         }
 
-        // 初始化点云渲染器
-        m_pointCloudRenderer = std::make_unique<PointCloudRenderer>(m_vulkanContext, m_camera);
-        if (!m_pointCloudRenderer->init()) {
-            Logger::error("Failed to initialize point cloud renderer!");
+        // 着色器热重载：监视场景渲染器的着色器文件（配置shader_hot_reload）
+        m_shaderReloader = std::make_unique<ShaderHotReloader>(m_vulkanContext);
+        m_shaderReloader->watch(m_coordinateRenderer.get(), "shaders/coord.vert.spv", "shaders/coord.frag.spv");
+        m_shaderReloader->watch(m_demoObjectRenderer.get(), "shaders/demo.vert.spv", "shaders/demo.frag.spv");
+        m_shaderReloader->watch(m_gridRenderer.get(), "shaders/grid.vert.spv", "shaders/grid.frag.spv");
+        m_shaderReloader->watch(m_pointCloudRenderer.get(), "shaders/pointcloud.vert.spv", "shaders/pointcloud.frag.spv");
+        // 点精灵和顶点拉取各有一份着色器模块，分别监视
+        if (ShaderReloadTarget* spriteTarget = m_pointCloudRenderer->getSpriteReloadTarget()) {
+            m_shaderReloader->watch(spriteTarget, "shaders/pointsprite.vert.spv", "shaders/pointsprite.frag.spv");
+        }
+        if (ShaderReloadTarget* pullTarget = m_pointCloudRenderer->getPullReloadTarget()) {
+            m_shaderReloader->watch(pullTarget, "shaders/pointpull.vert.spv", "shaders/pointcloud.frag.spv");
+        }
+        if (!m_shaderReloader->init()) {
+            Logger::error("Failed to initialize shader hot reloader!");
             cleanup();
             return false;
         }
@@ -112,136 +182,143 @@ void Renderer::drawFrame() {
     Logger::debug("  Entering drawFrame...");
     
     VkDevice device = m_vulkanContext->getDevice();
-    const std::vector<VkFence>& inFlightFences = m_vulkanContext->getInFlightFences();
     size_t currentFrame = m_vulkanContext->getCurrentFrame();
     
     Logger::debug("  Current frame: {}", currentFrame);
 
-    Logger::debug("  Calling vkWaitForFences...");
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-    Logger::debug("  vkWaitForFences succeeded!");
-
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(
-        device,
-        m_vulkanContext->getSwapchain(),
-        UINT64_MAX,
-        m_vulkanContext->getImageAvailableSemaphores()[currentFrame],
-        VK_NULL_HANDLE,
-        &imageIndex
-    );
-    
-    Logger::debug("  vkAcquireNextImageKHR result: {}", static_cast<int>(result));
+    // 等待该帧槽位空闲，回收其上传区并执行延迟删除
+    Logger::debug("  Waiting for frame...");
+    m_vulkanContext->waitForFrame();
+    Logger::debug("  Frame is available!");
+
+    // 换上后台重建好的管线（旧管线通过延迟删除在帧槽位空闲后销毁）
+    m_shaderReloader->applyPending();
 
-    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        throw std::runtime_error("Failed to acquire swap chain image!");
+    FrameContext& frame = m_vulkanContext->getCurrentFrameContext();
+    VkCommandBuffer commandBuffer = frame.getCommandBuffer();
+    VkFence inFlightFence = frame.getInFlightFence();
+
+    // 该帧槽位之前请求的回读已完成
+    if (m_frameReadback) {
+        m_frameReadback->collect(static_cast<uint32_t>(currentFrame));
+    }
+
+    bool headless = m_vulkanContext->isHeadless();
+
+    // 窗口大小改变后重建交换链；最小化时跳过这一帧
+    if (!headless && (m_vulkanContext->isFramebufferResized() ||
+                      m_vulkanContext->getSwapchain() == VK_NULL_HANDLE)) {
+        if (!recreateSwapchain()) {
+            // 本帧不提交，槽位栅栏不会在已排入的延迟删除（旧交换链、旧管线）之后
+            // 发出信号：等待所有飞行中的帧，使其在下次等待本槽位时可以安全执行
+            m_vulkanContext->waitForFramesInFlight();
+            Logger::debug("  Swapchain unavailable, skipping frame");
+            return;
+        }
+    }
+
+    // 无窗口模式下每帧使用自己的离屏图像，不需要获取交换链图像
+    uint32_t imageIndex = static_cast<uint32_t>(currentFrame);
+    VkResult result = VK_SUCCESS;
+    if (!headless) {
+        result = vkAcquireNextImageKHR(
+            device,
+            m_vulkanContext->getSwapchain(),
+            UINT64_MAX,
+            frame.getImageAvailableSemaphore(),
+            VK_NULL_HANDLE,
+            &imageIndex
+        );
+
+        Logger::debug("  vkAcquireNextImageKHR result: {}", static_cast<int>(result));
+
+        // 交换链已失效：重建后下一帧再渲染（栅栏尚未重置，可以直接返回；
+        // 同上，先等待所有飞行中的帧再让本槽位执行延迟删除）
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapchain();
+            m_vulkanContext->waitForFramesInFlight();
+            return;
+        }
+        if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("Failed to acquire swap chain image!");
+        }
     }
 
     Logger::debug("  Calling vkResetFences...");
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    vkResetFences(device, 1, &inFlightFence);
     Logger::debug("  vkResetFences succeeded!");
     
     Logger::debug("  Calling vkResetCommandBuffer...");
-    vkResetCommandBuffer(m_vulkanContext->getCommandBuffers()[currentFrame], 0);
+    vkResetCommandBuffer(commandBuffer, 0);
     Logger::debug("  vkResetCommandBuffer succeeded!");
 
     // 开始录制命令缓冲区
     Logger::debug("  Calling vkBeginCommandBuffer...");
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    if (vkBeginCommandBuffer(m_vulkanContext->getCommandBuffers()[currentFrame], &beginInfo) != VK_SUCCESS) {
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("Failed to begin command buffer recording!");
     }
     Logger::debug("  vkBeginCommandBuffer succeeded!");
 
-    // 绑定帧缓冲区
-    Logger::debug("  Binding framebuffer...");
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = m_vulkanContext->getRenderPass();
-    renderPassInfo.framebuffer = m_vulkanContext->getSwapchainFramebuffers()[imageIndex];
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = m_vulkanContext->getSwapchainExtent();
-    
-    VkClearValue clearColor = { {{0.1f, 0.1f, 0.1f, 1.0f}} };
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
-    
-    vkCmdBeginRenderPass(m_vulkanContext->getCommandBuffers()[currentFrame], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    // 绘制网格（先绘制，作为背景） - DISABLED
-    // Logger::debug("  Drawing grid...");
-    // if (m_gridRenderer) {
-    //     m_gridRenderer->draw(m_vulkanContext->getCommandBuffers()[currentFrame]);
-    // }
-
-    // 绘制演示物体 - DISABLED
-    // Logger::debug("  Drawing demo object...");
-    // if (m_demoObjectRenderer) {
-    //     m_demoObjectRenderer->draw(m_vulkanContext->getCommandBuffers()[currentFrame]);
-    // }
-
-    // 绘制坐标系 - DISABLED
-    // Logger::debug("  Drawing coordinate system...");
-    // if (m_coordinateRenderer) {
-    //     m_coordinateRenderer->draw(m_vulkanContext->getCommandBuffers()[currentFrame]);
-    // }
-
-    // 绘制点云
-    Logger::debug("  Drawing point cloud...");
+    // 写入本帧槽位的相机矩阵；网格按相机位置重建（必须在录制网格之前）
+    m_cameraUniforms->update(static_cast<uint32_t>(currentFrame));
+    if (m_showGrid && m_gridRenderer) {
+        m_gridRenderer->update();
+    }
+
+    // 更新点云数据
     if (m_pointCloudRenderer && m_pluginContext) {
         m_pointCloudRenderer->updatePoints(m_pluginContext);
-        m_pointCloudRenderer->draw(m_vulkanContext->getCommandBuffers()[currentFrame]);
     }
 
-    // 检查是否有UI需要更新和渲染
-    if (m_ui != nullptr) {
-        Logger::debug("  Calling UI::update()...");
-        m_ui->update();
-
-        // 执行ImGui渲染命令 - 注意：这必须在渲染通道内进行！
-        Logger::debug("  Calling ImGui_ImplVulkan_RenderDrawData...");
-        ImDrawData* drawData = ImGui::GetDrawData();
-        if (drawData && drawData->CmdListsCount > 0) {
-            ImGui_ImplVulkan_RenderDrawData(drawData, m_vulkanContext->getCommandBuffers()[currentFrame]);
-        }
-        Logger::debug("  ImGui_ImplVulkan_RenderDrawData succeeded!");
-    } else {
-        Logger::debug("  No UI to update, skipping...");
+    // 读取上一轮本槽位的点云GPU绘制耗时，并在渲染通道外重置时间戳查询
+    if (m_pointCloudRenderer && m_pluginContext) {
+        m_pointCloudRenderer->resetTimestamps(commandBuffer);
     }
-    
-    // 结束渲染通道
-    Logger::debug("  Calling vkCmdEndRenderPass...");
-    vkCmdEndRenderPass(m_vulkanContext->getCommandBuffers()[currentFrame]);
+
+    // 通过渲染图录制本帧的各个通道（GPU剔除、场景、回读），屏障由渲染图插入
+    buildFrameGraph(imageIndex, static_cast<uint32_t>(currentFrame));
+    m_renderGraph->execute(commandBuffer);
     
     // 结束录制命令缓冲区
     Logger::debug("  Calling vkEndCommandBuffer...");
-    if (vkEndCommandBuffer(m_vulkanContext->getCommandBuffers()[currentFrame]) != VK_SUCCESS) {
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("Failed to end command buffer recording!");
     }
     Logger::debug("  vkEndCommandBuffer succeeded!");
 
+    // 本帧排队的缓冲区上传合并为一次提交，排在本帧之前执行
+    m_vulkanContext->getUploadBatcher().flush();
+
     Logger::debug("  Creating submit info...");
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[] = { m_vulkanContext->getImageAvailableSemaphores()[currentFrame] };
+    VkSemaphore waitSemaphores[] = { frame.getImageAvailableSemaphore() };
     VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = headless ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &m_vulkanContext->getCommandBuffers()[currentFrame];
+    submitInfo.pCommandBuffers = &commandBuffer;
 
-    VkSemaphore signalSemaphores[] = { m_vulkanContext->getRenderFinishedSemaphores()[currentFrame] };
-    submitInfo.signalSemaphoreCount = 1;
+    VkSemaphore signalSemaphores[] = { frame.getRenderFinishedSemaphore() };
+    submitInfo.signalSemaphoreCount = headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
     Logger::debug("  Calling vkQueueSubmit...");
-    if (vkQueueSubmit(m_vulkanContext->getGraphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+    if (vkQueueSubmit(m_vulkanContext->getGraphicsQueue(), 1, &submitInfo, inFlightFence) != VK_SUCCESS) {
         throw std::runtime_error("Failed to submit draw command buffer!");
     }
     Logger::debug("  vkQueueSubmit succeeded!");
+    m_lastImageIndex = imageIndex;
+
+    if (headless) {
+        m_vulkanContext->nextFrame();
+        Logger::debug("  Exiting drawFrame (headless)...");
+        return;
+    }
 
     Logger::debug("  Creating present info...");
     VkPresentInfoKHR presentInfo{};
@@ -259,7 +336,10 @@ void Renderer::drawFrame() {
     result = vkQueuePresentKHR(m_vulkanContext->getPresentQueue(), &presentInfo);
     Logger::debug("  vkQueuePresentKHR result: {}", static_cast<int>(result));
 
-    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+    // 交换链失效或不再匹配窗口大小时，在下一帧等待栅栏之后重建
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+        m_vulkanContext->setFramebufferResized();
+    } else if (result != VK_SUCCESS) {
         throw std::runtime_error("Failed to present swap chain image!");
     }
 
@@ -270,6 +350,169 @@ void Renderer::drawFrame() {
     Logger::debug("  Exiting drawFrame...");
 }
 
+bool Renderer::recreateSwapchain() {
+    if (!m_vulkanContext->recreateSwapchain()) {
+        return false;
+    }
+
+    // 投影矩阵的宽高比跟随新的交换链大小
+    VkExtent2D extent = m_vulkanContext->getSwapchainExtent();
+    m_camera->setViewportSize(static_cast<int>(extent.width), static_cast<int>(extent.height));
+    return true;
+}
+
+void Renderer::buildFrameGraph(uint32_t imageIndex, uint32_t frameSlot) {
+    bool headless = m_vulkanContext->isHeadless();
+    VkImage colorImage = m_vulkanContext->getSwapchainImages()[imageIndex];
+    // 渲染通道结束时颜色图像的布局
+    VkImageLayout presentLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    m_renderGraph->reset();
+
+    // 颜色图像是本帧的输出（呈现或离屏）
+    RenderGraph::ResourceHandle colorTarget = m_renderGraph->importImage("color", colorImage, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_renderGraph->exportResource(colorTarget, { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, presentLayout });
+
+    // GPU剔除：写入间接绘制命令，场景通道读取命令，主机读取计数
+    bool drawPoints = m_pointCloudRenderer && m_pluginContext;
+    RenderGraph::ResourceHandle cullBuffer = RenderGraph::INVALID_RESOURCE;
+    if (drawPoints && m_pointCloudRenderer->isGpuCullingEnabled() &&
+        m_pointCloudRenderer->getCullBuffer() != VK_NULL_HANDLE) {
+        // 上一帧的间接绘制仍可能在读取命令
+        cullBuffer = m_renderGraph->importBuffer("point cull", m_pointCloudRenderer->getCullBuffer(),
+                                                 { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT });
+        m_renderGraph->exportResource(cullBuffer, { VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT });
+        m_renderGraph->addPass("point cull", [this](VkCommandBuffer cb) { m_pointCloudRenderer->cull(cb); })
+            .write(cullBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                   VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    }
+
+    // 场景和UI：渲染通道自行完成颜色和深度附件的布局转换
+    RenderGraph::PassBuilder scenePass = m_renderGraph->addPass("scene",
+        [this, imageIndex, frameSlot](VkCommandBuffer cb) { recordRenderPass(cb, imageIndex, frameSlot); });
+    scenePass.write(colorTarget, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_UNDEFINED, presentLayout);
+    if (cullBuffer != RenderGraph::INVALID_RESOURCE) {
+        scenePass.read(cullBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+    }
+
+    // 无窗口模式下将渲染结果复制到回读缓冲区
+    if (m_frameReadback && headless && m_frameReadback->isRequested()) {
+        VkBuffer buffer = m_frameReadback->getBuffer(frameSlot);
+        if (buffer != VK_NULL_HANDLE) {
+            RenderGraph::ResourceHandle readbackBuffer = m_renderGraph->importBuffer("readback", buffer);
+            m_renderGraph->exportResource(readbackBuffer, { VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT });
+            m_renderGraph->addPass("readback", [this, colorImage, frameSlot](VkCommandBuffer cb) {
+                    m_frameReadback->record(cb, colorImage, frameSlot);
+                })
+                .read(colorTarget, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+                .write(readbackBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+        }
+    }
+}
+
+void Renderer::recordRenderPass(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t frameSlot) {
+    bool parallel = m_parallelRecorder->isParallel();
+    bool secondaries = parallel || m_cacheStaticCommands;
+    VkFramebuffer framebuffer = m_vulkanContext->getSwapchainFramebuffers()[imageIndex];
+
+    // 绑定帧缓冲区
+    Logger::debug("  Binding framebuffer...");
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = m_vulkanContext->getRenderPass();
+    renderPassInfo.framebuffer = framebuffer;
+    renderPassInfo.renderArea.offset = { 0, 0 };
+    renderPassInfo.renderArea.extent = m_vulkanContext->getSwapchainExtent();
+    
+    VkClearValue clearValues[2]{};
+    clearValues[0].color = { {0.1f, 0.1f, 0.1f, 1.0f} };
+    clearValues[1].depthStencil = { 1.0f, 0 };
+    renderPassInfo.clearValueCount = 2;
+    renderPassInfo.pClearValues = clearValues;
+    
+    // 使用二级命令缓冲区时子通道内容全部来自二级命令缓冲区
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
+                         secondaries ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+    if (secondaries) {
+        m_parallelRecorder->beginFrame(frameSlot, framebuffer);
+    }
+
+    // 场景各层按顺序执行：网格（背景）、演示物体、坐标系、点云
+    // 前三层只通过uniform读取相机，命令本身不随相机变化，可以缓存
+    enum StaticLayer : uint32_t { STATIC_LAYER_GRID = 0, STATIC_LAYER_DEMO_OBJECT, STATIC_LAYER_AXES };
+    struct SceneLayer {
+        uint32_t staticLayer;
+        uint64_t version;
+        ParallelRecorder::RecordFunction record;
+    };
+    std::vector<SceneLayer> staticLayers;
+    if (m_showGrid && m_gridRenderer) {
+        uint64_t gridVersion = m_gridRenderer->getGeometryVersion() + m_gridRenderer->getPipelineVersion();
+        staticLayers.push_back({ STATIC_LAYER_GRID, gridVersion,
+                                 [this, frameSlot](VkCommandBuffer cb) { m_gridRenderer->draw(cb, frameSlot); } });
+    }
+    if (m_showDemoObject && m_demoObjectRenderer) {
+        // 线框切换和着色器重载会更换管线，缓存的命令需要重新录制
+        staticLayers.push_back({ STATIC_LAYER_DEMO_OBJECT, m_demoObjectRenderer->getPipelineVersion(),
+                                 [this, frameSlot](VkCommandBuffer cb) { m_demoObjectRenderer->draw(cb, frameSlot); } });
+    }
+    if (m_showAxes && m_coordinateRenderer) {
+        staticLayers.push_back({ STATIC_LAYER_AXES, m_coordinateRenderer->getPipelineVersion(),
+                                 [this, frameSlot](VkCommandBuffer cb) { m_coordinateRenderer->draw(cb, frameSlot); } });
+    }
+
+    std::vector<ParallelRecorder::RecordFunction> scenePasses;
+    if (m_cacheStaticCommands) {
+        // 缓存的静态层先于动态层执行，保持原有的绘制顺序
+        for (const auto& layer : staticLayers) {
+            m_parallelRecorder->executeStatic(commandBuffer, layer.staticLayer, layer.version, layer.record);
+        }
+    } else {
+        for (const auto& layer : staticLayers) {
+            scenePasses.push_back(layer.record);
+        }
+    }
+    if (m_pointCloudRenderer && m_pluginContext) {
+        scenePasses.push_back([this](VkCommandBuffer cb) { m_pointCloudRenderer->draw(cb); });
+    }
+
+    Logger::debug("  Recording {} scene passes{}...", scenePasses.size(), parallel ? " in parallel" : "");
+    if (secondaries) {
+        m_parallelRecorder->execute(commandBuffer, scenePasses);
+    } else {
+        for (const auto& pass : scenePasses) {
+            pass(commandBuffer);
+        }
+    }
+
+    // 检查是否有UI需要更新和渲染；UI显示本帧的绘制统计，所以在场景录制完成后更新
+    if (m_ui != nullptr) {
+        Logger::debug("  Calling UI::update()...");
+        m_ui->update();
+
+        // 执行ImGui渲染命令 - 注意：这必须在渲染通道内进行！
+        Logger::debug("  Calling ImGui_ImplVulkan_RenderDrawData...");
+        ImDrawData* drawData = ImGui::GetDrawData();
+        if (drawData && drawData->CmdListsCount > 0) {
+            auto uiPass = [drawData](VkCommandBuffer cb) { ImGui_ImplVulkan_RenderDrawData(drawData, cb); };
+            if (secondaries) {
+                m_parallelRecorder->execute(commandBuffer, { uiPass });
+            } else {
+                uiPass(commandBuffer);
+            }
+        }
+        Logger::debug("  ImGui_ImplVulkan_RenderDrawData succeeded!");
+    } else {
+        Logger::debug("  No UI to update, skipping...");
+    }
+    
+    // 结束渲染通道
+    Logger::debug("  Calling vkCmdEndRenderPass...");
+    vkCmdEndRenderPass(commandBuffer);
+}
+
 void Renderer::drawCoordinateSystem() {
     // 这个函数将在UI类中实现，使用ImGui绘制坐标系
 }
@@ -278,7 +521,35 @@ void Renderer::drawGrid() {
     // 这个函数将在UI类中实现，使用ImGui绘制网格
 }
 
+void Renderer::setWireframe(bool wireframe) {
+    if (m_demoObjectRenderer) {
+        m_demoObjectRenderer->setWireframe(wireframe);
+    }
+}
+
+bool Renderer::isWireframe() const {
+    return m_demoObjectRenderer && m_demoObjectRenderer->isWireframe();
+}
+
 void Renderer::cleanup() {
+    // 先停止着色器重载线程，它会访问各场景渲染器
+    if (m_shaderReloader) {
+        m_shaderReloader->cleanup();
+        m_shaderReloader.reset();
+    }
+
+    // 释放渲染图的临时图像
+    if (m_renderGraph) {
+        m_renderGraph->cleanup();
+        m_renderGraph.reset();
+    }
+
+    // 先等待并释放二级命令缓冲区
+    if (m_parallelRecorder) {
+        m_parallelRecorder->cleanup();
+        m_parallelRecorder.reset();
+    }
+
     // 清理坐标系渲染器
     if (m_coordinateRenderer) {
         m_coordinateRenderer->cleanup();
@@ -303,6 +574,12 @@ void Renderer::cleanup() {
         m_pointCloudRenderer.reset();
     }
 
+    // 清理相机uniform缓冲区（渲染器的管线布局引用其描述符集布局）
+    if (m_cameraUniforms) {
+        m_cameraUniforms->cleanup();
+        m_cameraUniforms.reset();
+    }
+
     if (m_descriptorPool != VK_NULL_HANDLE) {
         vkDestroyDescriptorPool(m_vulkanContext->getDevice(), m_descriptorPool, nullptr);
         m_descriptorPool = VK_NULL_HANDLE;
@@ -10,6 +10,11 @@ class DemoObjectRenderer;
 class GridRenderer;
 class PointCloudRenderer;
 class PluginContext;
+class FrameReadback;
+class ParallelRecorder;
+class CameraUniforms;
+class RenderGraph;
+class ShaderHotReloader;
 
 class Renderer {
 public:
@@ -23,14 +28,28 @@ public:
     // Setters
     void setUI(UI* ui) { m_ui = ui; }
     void setPluginContext(PluginContext* ctx) { m_pluginContext = ctx; }
+    // Optional readback of rendered frames (headless mode)
+    void setFrameReadback(FrameReadback* readback) { m_frameReadback = readback; }
+    // Optional scene layers (config show_grid, show_axes, show_demo_object)
+    void setShowGrid(bool show) { m_showGrid = show; }
+    void setShowAxes(bool show) { m_showAxes = show; }
+    void setShowDemoObject(bool show) { m_showDemoObject = show; }
+    // Draw the demo object as wireframe (UI "Show Wireframe")
+    void setWireframe(bool wireframe);
+    bool isWireframe() const;
 
     // Getters
     VkDescriptorPool getDescriptorPool() const { return m_descriptorPool; }
     GridRenderer* getGridRenderer() const { return m_gridRenderer.get(); }
     PointCloudRenderer* getPointCloudRenderer() const { return m_pointCloudRenderer.get(); }
+    // Swapchain (or offscreen) image the last frame was rendered into
+    uint32_t getLastImageIndex() const { return m_lastImageIndex; }
 
 private:
     void drawFrame();
+    bool recreateSwapchain();
+    void buildFrameGraph(uint32_t imageIndex, uint32_t frameSlot);
+    void recordRenderPass(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t frameSlot);
     void drawCoordinateSystem();
     void drawGrid();
 
@@ -38,10 +57,25 @@ private:
     Camera* m_camera;
     UI* m_ui;
     PluginContext* m_pluginContext;
+    FrameReadback* m_frameReadback;
     VkDescriptorPool m_descriptorPool;
+    uint32_t m_lastImageIndex;
+    bool m_showGrid;
+    bool m_showAxes;
+    bool m_showDemoObject;
+    // Record grid, axes and demo object once per frame slot and reuse them
+    bool m_cacheStaticCommands;
 
+    // Per-frame camera matrices shared by the static scene layers
+    std::unique_ptr<CameraUniforms> m_cameraUniforms;
     std::unique_ptr<CoordinateSystemRenderer> m_coordinateRenderer;
     std::unique_ptr<DemoObjectRenderer> m_demoObjectRenderer;
     std::unique_ptr<GridRenderer> m_gridRenderer;
     std::unique_ptr<PointCloudRenderer> m_pointCloudRenderer;
+    // Records the scene renderers into secondary command buffers on worker threads
+    std::unique_ptr<ParallelRecorder> m_parallelRecorder;
+    // Orders the passes of a frame and inserts the barriers between them
+    std::unique_ptr<RenderGraph> m_renderGraph;
+    // Rebuilds the scene pipelines in the background when shader files change
+    std::unique_ptr<ShaderHotReloader> m_shaderReloader;
 };
@@ -1,8 +1,77 @@
 #include "ShaderCompiler.h"
+#include "Config.h"
 #include "Logger.h"
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <stdexcept>
 
+#ifdef HAS_SHADERC
+#include <shaderc/shaderc.hpp>
+#endif
+
+#ifdef HAS_EMBEDDED_SHADERS
+#include "EmbeddedShaders.h"
+#endif
+
+// Default GLSL source directory; the build points it at src/shaders
+#ifndef SHADER_SOURCE_DIR
+#define SHADER_SOURCE_DIR "shaders"
+#endif
+
+namespace {
+
+// Bump when the compile options change so cached SPIR-V is not reused
+const uint32_t SHADER_CACHE_VERSION = 1;
+
+uint64_t hashSource(const std::string& source) {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull ^ SHADER_CACHE_VERSION;
+    for (unsigned char c : source) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool readTextFile(const std::string& filename, std::string& text) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    text = stream.str();
+    return true;
+}
+
+bool writeSPIRV(const std::string& filename, const std::vector<uint32_t>& spirv) {
+    // Write a temporary file first so a concurrent reader never sees a partial file
+    std::string tempFile = filename + ".tmp";
+    {
+        std::ofstream file(tempFile, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+        file.close();
+        if (!file) {
+            std::remove(tempFile.c_str());
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempFile, filename, error);
+    if (error) {
+        std::remove(tempFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
 std::vector<uint32_t> ShaderCompiler::loadSPIRV(const std::string& filename) {
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
@@ -43,7 +112,141 @@ VkShaderModule ShaderCompiler::createShaderModule(VkDevice device, const std::ve
 }
 
 VkShaderModule ShaderCompiler::loadAndCreateModule(VkDevice device, const std::string& filename) {
-    auto spirv = loadSPIRV(filename);
+    std::vector<uint32_t> spirv;
+    if (Config::getInstance().getBool("embedded_shaders", true) && findEmbeddedSPIRV(filename, spirv)) {
+        Logger::debug("Using embedded shader: {} ({} bytes)", filename, spirv.size() * sizeof(uint32_t));
+    } else {
+        spirv = loadShader(filename);
+    }
     return createShaderModule(device, spirv);
 }
 
+bool ShaderCompiler::findEmbeddedSPIRV(const std::string& filename, std::vector<uint32_t>& spirv) {
+#ifdef HAS_EMBEDDED_SHADERS
+    std::string name = std::filesystem::path(filename).filename().string();
+    for (const auto& entry : EmbeddedShaders::entries) {
+        if (name == entry.name) {
+            spirv.assign(entry.code, entry.code + entry.wordCount);
+            return true;
+        }
+    }
+#else
+    (void)filename;
+    (void)spirv;
+#endif
+    return false;
+}
+
+bool ShaderCompiler::isRuntimeCompilationAvailable() {
+#ifdef HAS_SHADERC
+    return Config::getInstance().getBool("shader_runtime_compile", true);
+#else
+    return false;
+#endif
+}
+
+std::vector<uint32_t> ShaderCompiler::compileGLSL(const std::string& source, ShaderType type, const std::string& name) {
+#ifdef HAS_SHADERC
+    shaderc_shader_kind kind = shaderc_glsl_vertex_shader;
+    switch (type) {
+        case ShaderType::Vertex: kind = shaderc_glsl_vertex_shader; break;
+        case ShaderType::Fragment: kind = shaderc_glsl_fragment_shader; break;
+        case ShaderType::Geometry: kind = shaderc_glsl_geometry_shader; break;
+        case ShaderType::Compute: kind = shaderc_glsl_compute_shader; break;
+    }
+
+    shaderc::CompileOptions options;
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0);
+    options.SetOptimizationLevel(shaderc_optimization_level_performance);
+
+    shaderc::Compiler compiler;
+    shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, kind, name.c_str(), options);
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+        throw std::runtime_error("Failed to compile shader " + name + ":\n" + result.GetErrorMessage());
+    }
+    if (result.GetNumWarnings() > 0) {
+        Logger::warn("Shader {} compiled with warnings:\n{}", name, result.GetErrorMessage());
+    }
+    return std::vector<uint32_t>(result.cbegin(), result.cend());
+#else
+    (void)source;
+    (void)type;
+    throw std::runtime_error("Runtime shader compilation is not available, cannot compile " + name);
+#endif
+}
+
+std::string ShaderCompiler::getSourcePath(const std::string& spirvFilename) {
+    std::filesystem::path path(spirvFilename);
+    if (path.extension() == ".spv") {
+        path.replace_extension();
+    }
+
+    std::string sourceDir = Config::getInstance().getString("shader_source_dir", SHADER_SOURCE_DIR);
+    std::filesystem::path sourcePath = std::filesystem::path(sourceDir) / path.filename();
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(sourcePath, error)) {
+        return std::string();
+    }
+    return sourcePath.string();
+}
+
+ShaderCompiler::ShaderType ShaderCompiler::getShaderType(const std::string& filename) {
+    std::filesystem::path path(filename);
+    if (path.extension() == ".spv") {
+        path.replace_extension();
+    }
+    std::string extension = path.extension().string();
+    if (extension == ".frag") return ShaderType::Fragment;
+    if (extension == ".geom") return ShaderType::Geometry;
+    if (extension == ".comp") return ShaderType::Compute;
+    return ShaderType::Vertex;
+}
+
+std::vector<uint32_t> ShaderCompiler::loadShader(const std::string& spirvFilename, bool allowFallback) {
+    std::string sourcePath = getSourcePath(spirvFilename);
+
+    if (!sourcePath.empty() && isRuntimeCompilationAvailable()) {
+        std::string source;
+        if (readTextFile(sourcePath, source)) {
+            std::string name = std::filesystem::path(sourcePath).filename().string();
+
+            // Compiled SPIR-V is cached by content, so unchanged sources are never recompiled
+            char hashText[17];
+            snprintf(hashText, sizeof(hashText), "%016llx", static_cast<unsigned long long>(hashSource(source)));
+            std::filesystem::path cacheDir(Config::getInstance().getString("shader_cache_dir", "shader_cache"));
+            std::string cachedFile = (cacheDir / (name + "." + hashText + ".spv")).string();
+
+            std::error_code error;
+            if (std::filesystem::is_regular_file(cachedFile, error)) {
+                return loadSPIRV(cachedFile);
+            }
+
+            try {
+                std::vector<uint32_t> spirv = compileGLSL(source, getShaderType(sourcePath), name);
+                std::filesystem::create_directories(cacheDir, error);
+                if (!writeSPIRV(cachedFile, spirv)) {
+                    Logger::warn("Failed to write shader cache: {}", cachedFile);
+                }
+                Logger::info("Compiled shader {} ({} bytes of SPIR-V)", sourcePath, spirv.size() * sizeof(uint32_t));
+                return spirv;
+            } catch (const std::exception& e) {
+                if (!allowFallback) {
+                    throw;
+                }
+                Logger::error("{}", e.what());
+                Logger::warn("Falling back to prebuilt shader: {}", spirvFilename);
+            }
+        }
+    } else if (!sourcePath.empty()) {
+        // Without runtime compilation a prebuilt file older than its source is likely stale
+        std::error_code sourceError;
+        std::error_code spirvError;
+        auto sourceTime = std::filesystem::last_write_time(sourcePath, sourceError);
+        auto spirvTime = std::filesystem::last_write_time(spirvFilename, spirvError);
+        if (!sourceError && !spirvError && spirvTime < sourceTime) {
+            Logger::warn("Shader {} is older than its source {}, recompile the shaders", spirvFilename, sourcePath);
+        }
+    }
+
+    return loadSPIRV(spirvFilename);
+}
@@ -19,7 +19,30 @@ public:
     // Create Vulkan shader module from SPIR-V
     static VkShaderModule createShaderModule(VkDevice device, const std::vector<uint32_t>& spirv);
 
-    // Convenience function: load SPIR-V and create shader module
+    // Convenience function: load SPIR-V and create shader module. Uses the
+    // copy embedded at build time when there is one (config embedded_shaders),
+    // otherwise loadShader()
     static VkShaderModule loadAndCreateModule(VkDevice device, const std::string& filename);
-};
 
+    // SPIR-V embedded in the executable, looked up by file name ("grid.vert.spv");
+    // false if the build did not embed it
+    static bool findEmbeddedSPIRV(const std::string& filename, std::vector<uint32_t>& spirv);
+
+    // Runtime GLSL compilation (built with shaderc, config shader_runtime_compile)
+    static bool isRuntimeCompilationAvailable();
+    // Compile GLSL source; throws std::runtime_error with the compiler output on failure
+    static std::vector<uint32_t> compileGLSL(const std::string& source, ShaderType type, const std::string& name);
+
+    // GLSL source of a SPIR-V path ("shaders/grid.vert.spv" -> "<shader_source_dir>/grid.vert");
+    // empty if the source does not exist
+    static std::string getSourcePath(const std::string& spirvFilename);
+    // Shader type from the extension (.vert, .frag, .geom, .comp), with or without ".spv"
+    static ShaderType getShaderType(const std::string& filename);
+
+    // Load the SPIR-V for 'spirvFilename'. With runtime compilation the GLSL
+    // source is compiled instead, through a cache in shader_cache_dir keyed by
+    // the source's content hash; a source that fails to compile falls back to
+    // the prebuilt file unless 'allowFallback' is false, in which case the
+    // compile error is thrown. Throws std::runtime_error if nothing loads.
+    static std::vector<uint32_t> loadShader(const std::string& spirvFilename, bool allowFallback = true);
+};
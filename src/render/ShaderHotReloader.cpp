@@ -0,0 +1,175 @@
+#include "ShaderHotReloader.h"
+#include "ShaderCompiler.h"
+#include "VulkanContext.h"
+#include "Config.h"
+#include "Logger.h"
+#include <chrono>
+#include <exception>
+
+ShaderHotReloader::ShaderHotReloader(VulkanContext* vulkanContext)
+    : m_vulkanContext(vulkanContext), m_stopping(false), m_intervalMs(500) {}
+
+ShaderHotReloader::~ShaderHotReloader() {
+    cleanup();
+}
+
+bool ShaderHotReloader::init() {
+    try {
+        Config& config = Config::getInstance();
+        if (!config.getBool("shader_hot_reload", false)) {
+            return true;
+        }
+        m_intervalMs = config.getInt("shader_reload_interval_ms", 500);
+        if (m_intervalMs < 50) {
+            m_intervalMs = 50;
+        }
+
+        m_stopping = false;
+        m_thread = std::thread(&ShaderHotReloader::reloadLoop, this);
+        Logger::info("Shader hot reload enabled ({}, every {} ms)",
+                     ShaderCompiler::isRuntimeCompilationAvailable() ? "GLSL sources" : "SPIR-V files", m_intervalMs);
+        return true;
+    } catch (const std::exception& e) {
+        Logger::error("Shader hot reloader initialization error: {}", e.what());
+        return false;
+    }
+}
+
+void ShaderHotReloader::cleanup() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+    }
+
+    // Rebuilds that were never applied have not been used by any frame
+    std::lock_guard<std::mutex> lock(m_mutex);
+    VkDevice device = m_vulkanContext->getDevice();
+    for (const auto& result : m_pending) {
+        m_vulkanContext->getPipelineBuilder().destroyPipelines(result.vertexShader);
+        vkDestroyShaderModule(device, result.fragmentShader, nullptr);
+        vkDestroyShaderModule(device, result.vertexShader, nullptr);
+    }
+    m_pending.clear();
+    m_programs.clear();
+}
+
+void ShaderHotReloader::watch(ShaderReloadTarget* target, const std::string& vertexShader,
+                              const std::string& fragmentShader) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_programs.push_back({ target, makeWatchedFile(vertexShader), makeWatchedFile(fragmentShader) });
+}
+
+void ShaderHotReloader::applyPending() {
+    std::vector<ReloadResult> results;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pending.empty()) {
+            return;
+        }
+        results.swap(m_pending);
+    }
+
+    for (const auto& result : results) {
+        result.target->replaceShaders(result.vertexShader, result.fragmentShader, result.pipeline);
+    }
+    Logger::info("Applied {} reloaded shader program(s)", results.size());
+}
+
+void ShaderHotReloader::retireShaders(VulkanContext* vulkanContext, VkShaderModule vertexShader,
+                                      VkShaderModule fragmentShader) {
+    vulkanContext->deferDelete([vulkanContext, vertexShader, fragmentShader]() {
+        if (vertexShader != VK_NULL_HANDLE) {
+            vulkanContext->getPipelineBuilder().destroyPipelines(vertexShader);
+            vkDestroyShaderModule(vulkanContext->getDevice(), vertexShader, nullptr);
+        }
+        if (fragmentShader != VK_NULL_HANDLE) {
+            vkDestroyShaderModule(vulkanContext->getDevice(), fragmentShader, nullptr);
+        }
+    });
+}
+
+ShaderHotReloader::WatchedFile ShaderHotReloader::makeWatchedFile(const std::string& shader) {
+    WatchedFile file;
+    file.shader = shader;
+    file.watched = shader;
+    if (ShaderCompiler::isRuntimeCompilationAvailable()) {
+        std::string source = ShaderCompiler::getSourcePath(shader);
+        if (!source.empty()) {
+            file.watched = source;
+        }
+    }
+    std::error_code error;
+    file.lastWrite = std::filesystem::last_write_time(file.watched, error);
+    return file;
+}
+
+bool ShaderHotReloader::hasChanged(WatchedFile& file) {
+    std::error_code error;
+    auto lastWrite = std::filesystem::last_write_time(file.watched, error);
+    if (error || lastWrite == file.lastWrite) {
+        return false;
+    }
+    file.lastWrite = lastWrite;
+    return true;
+}
+
+void ShaderHotReloader::reloadLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_intervalMs), [this]() { return m_stopping; });
+        if (m_stopping) {
+            break;
+        }
+
+        std::vector<WatchedProgram> changed;
+        for (auto& program : m_programs) {
+            // Evaluate both so a save of either file is recorded
+            bool vertexChanged = hasChanged(program.vertex);
+            bool fragmentChanged = hasChanged(program.fragment);
+            if (vertexChanged || fragmentChanged) {
+                changed.push_back(program);
+            }
+        }
+        if (changed.empty()) {
+            continue;
+        }
+
+        // Compile and build without the lock; the render thread only waits for it in applyPending()
+        lock.unlock();
+        for (const auto& program : changed) {
+            reload(program);
+        }
+        lock.lock();
+    }
+}
+
+void ShaderHotReloader::reload(const WatchedProgram& program) {
+    VkDevice device = m_vulkanContext->getDevice();
+    VkShaderModule vertexShader = VK_NULL_HANDLE;
+    VkShaderModule fragmentShader = VK_NULL_HANDLE;
+    try {
+        auto start = std::chrono::steady_clock::now();
+        vertexShader = ShaderCompiler::createShaderModule(device, ShaderCompiler::loadShader(program.vertex.shader, false));
+        fragmentShader = ShaderCompiler::createShaderModule(device, ShaderCompiler::loadShader(program.fragment.shader, false));
+        VkPipeline pipeline = program.target->buildPipeline(vertexShader, fragmentShader);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Logger::info("Reloaded {} / {} in {:.1f} ms", program.vertex.watched, program.fragment.watched, ms);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back({ program.target, vertexShader, fragmentShader, pipeline });
+    } catch (const std::exception& e) {
+        // Keep the current shaders until the file is saved again
+        Logger::error("Shader reload failed: {}", e.what());
+        if (vertexShader != VK_NULL_HANDLE) {
+            m_vulkanContext->getPipelineBuilder().destroyPipelines(vertexShader);
+            vkDestroyShaderModule(device, vertexShader, nullptr);
+        }
+        if (fragmentShader != VK_NULL_HANDLE) {
+            vkDestroyShaderModule(device, fragmentShader, nullptr);
+        }
+    }
+}
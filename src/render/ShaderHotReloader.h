@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class VulkanContext;
+
+// A renderer whose vertex/fragment shaders can be replaced while running
+class ShaderReloadTarget {
+public:
+    virtual ~ShaderReloadTarget() = default;
+
+    // Build the pipeline for the new modules; called on the reload thread, so
+    // it may only read state that does not change after init()
+    virtual VkPipeline buildPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader) = 0;
+    // Swap in the new modules and pipeline; called on the render thread before
+    // recording. The target owns the modules from now on.
+    virtual void replaceShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkPipeline pipeline) = 0;
+};
+
+// Watches shader files and rebuilds the affected pipelines on a background
+// thread, so an edit never stalls the frame. Finished rebuilds are handed to
+// their targets by applyPending() on the render thread.
+//
+// With runtime compilation the GLSL sources are watched, otherwise the
+// prebuilt .spv files. Enabled by config shader_hot_reload, polled every
+// shader_reload_interval_ms milliseconds.
+class ShaderHotReloader {
+public:
+    explicit ShaderHotReloader(VulkanContext* vulkanContext);
+    ~ShaderHotReloader();
+
+    bool init();
+    void cleanup();
+
+    // Paths are the .spv files the target was created from
+    void watch(ShaderReloadTarget* target, const std::string& vertexShader, const std::string& fragmentShader);
+    // Hand finished rebuilds to their targets; call once per frame after waitForFrame()
+    void applyPending();
+
+    bool isEnabled() const { return m_thread.joinable(); }
+
+    // Destroy replaced modules and their pipelines once the frames in flight
+    // no longer use them; call on the render thread
+    static void retireShaders(VulkanContext* vulkanContext, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+
+private:
+    struct WatchedFile {
+        std::string shader;     // .spv path passed to ShaderCompiler::loadShader
+        std::string watched;    // file polled for changes
+        std::filesystem::file_time_type lastWrite;
+    };
+
+    struct WatchedProgram {
+        ShaderReloadTarget* target;
+        WatchedFile vertex;
+        WatchedFile fragment;
+    };
+
+    struct ReloadResult {
+        ShaderReloadTarget* target;
+        VkShaderModule vertexShader;
+        VkShaderModule fragmentShader;
+        VkPipeline pipeline;
+    };
+
+    static WatchedFile makeWatchedFile(const std::string& shader);
+    static bool hasChanged(WatchedFile& file);
+    void reloadLoop();
+    void reload(const WatchedProgram& program);
+
+    VulkanContext* m_vulkanContext;
+    std::vector<WatchedProgram> m_programs;
+    std::vector<ReloadResult> m_pending;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+    int m_intervalMs;
+};
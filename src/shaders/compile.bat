@@ -22,5 +22,23 @@ echo Compiling demo vertex shader...
 echo Compiling demo fragment shader...
 %GLSLC% -fshader-stage=fragment -o shaders/demo.frag.spv demo.frag
 
+echo Compiling point cloud vertex shader...
+%GLSLC% -fshader-stage=vertex -o shaders/pointcloud.vert.spv pointcloud.vert
+
+echo Compiling point cloud fragment shader...
+%GLSLC% -fshader-stage=fragment -o shaders/pointcloud.frag.spv pointcloud.frag
+
+echo Compiling point pull vertex shader...
+%GLSLC% -fshader-stage=vertex -o shaders/pointpull.vert.spv pointpull.vert
+
+echo Compiling point sprite vertex shader...
+%GLSLC% -fshader-stage=vertex -o shaders/pointsprite.vert.spv pointsprite.vert
+
+echo Compiling point sprite fragment shader...
+%GLSLC% -fshader-stage=fragment -o shaders/pointsprite.frag.spv pointsprite.frag
+
+echo Compiling point cull compute shader...
+%GLSLC% -fshader-stage=compute -o shaders/pointcull.comp.spv pointcull.comp
+
 echo Done!
 
@@ -1,8 +1,10 @@
 #version 450
 
-layout(push_constant) uniform PushConstants {
-    mat4 mvp;
-} pc;
+layout(set = 0, binding = 0) uniform CameraUniforms {
+    mat4 viewProjection;
+    mat4 view;
+    mat4 projection;
+} camera;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -12,7 +14,7 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragNormal;
 
 void main() {
-    gl_Position = pc.mvp * vec4(inPosition, 1.0);
+    gl_Position = camera.viewProjection * vec4(inPosition, 1.0);
     fragColor = inColor;
     fragNormal = inNormal;
 }
@@ -1,15 +1,42 @@
 #version 450
 
+// Point shape, fixed per pipeline (PointShape in PointCloudRenderer.h):
+// 0 square, 1 circle, 2 smooth disc, 3 gaussian splat
+layout(constant_id = 0) const int POINT_SHAPE = 1;
+
 layout(location = 0) in vec3 fragColor;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    // Make points circular
-    vec2 coord = gl_PointCoord - vec2(0.5);
-    if (length(coord) > 0.5) {
-        discard;
+    // Square points never discard, so early depth testing stays enabled
+    if (POINT_SHAPE == 0) {
+        outColor = vec4(fragColor, 1.0);
+        return;
     }
-    outColor = vec4(fragColor, 1.0);
-}
 
+    // Distance from the point center, 1 at the edge of the disc
+    float r = length(gl_PointCoord - vec2(0.5)) * 2.0;
+
+    if (POINT_SHAPE == 1) {
+        // Make points circular
+        if (r > 1.0) {
+            discard;
+        }
+        outColor = vec4(fragColor, 1.0);
+    } else if (POINT_SHAPE == 2) {
+        // Antialiased edge about one pixel wide
+        float alpha = 1.0 - smoothstep(1.0 - fwidth(r), 1.0, r);
+        if (alpha <= 0.0) {
+            discard;
+        }
+        outColor = vec4(fragColor, alpha);
+    } else {
+        // Gaussian falloff with sigma a third of the radius
+        float alpha = exp(-4.5 * r * r);
+        if (alpha < 1.0 / 255.0) {
+            discard;
+        }
+        outColor = vec4(fragColor, alpha);
+    }
+}
@@ -0,0 +1,52 @@
+#version 450
+
+// Point list vertex shader with vertex pulling: instead of vertex attributes
+// the point attributes are read from the point buffer's columns, bound as
+// storage buffers, by gl_VertexIndex. Each column is a binding of its own, so
+// columns are uploaded and updated independently, and the optional label
+// column is only read by the HAS_LABELS variant.
+
+// The points have a label column (binding 3)
+layout(constant_id = 0) const bool HAS_LABELS = false;
+
+layout(std430, set = 0, binding = 0) readonly buffer Positions {
+    float positions[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Colors {
+    float colors[];
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer Sizes {
+    float sizes[];
+};
+
+layout(std430, set = 0, binding = 3) readonly buffer Labels {
+    uint labels[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 mvp;
+} pc;
+
+layout(location = 0) out vec3 fragColor;
+
+// A distinct hue per label id, stepping the hue by the golden ratio
+vec3 labelColor(uint label) {
+    float hue = fract(float(label) * 0.61803398875);
+    return clamp(abs(mod(hue * 6.0 + vec3(0.0, 4.0, 2.0), 6.0) - 3.0) - 1.0, 0.0, 1.0);
+}
+
+void main() {
+    uint point = uint(gl_VertexIndex);
+
+    vec3 position = vec3(positions[point * 3], positions[point * 3 + 1], positions[point * 3 + 2]);
+    gl_Position = pc.mvp * vec4(position, 1.0);
+    gl_PointSize = sizes[point];
+
+    fragColor = vec3(colors[point * 3], colors[point * 3 + 1], colors[point * 3 + 2]);
+    // Label 0 is unlabelled and keeps its own color
+    if (HAS_LABELS && labels[point] != 0u) {
+        fragColor = labelColor(labels[point]);
+    }
+}
@@ -0,0 +1,57 @@
+#version 450
+
+// Point sprites drawn as instanced quads: one instance per point, a triangle
+// strip of four vertices per quad. Unlike gl_PointSize the size is not clamped
+// to the device's point size range. The point attributes are pulled from the
+// point buffer's columns, bound as storage buffers.
+
+// The points have a label column (binding 3), see pointpull.vert
+layout(constant_id = 0) const bool HAS_LABELS = false;
+
+layout(std430, set = 0, binding = 0) readonly buffer Positions {
+    float positions[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Colors {
+    float colors[];
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer Sizes {
+    float sizes[];
+};
+
+layout(std430, set = 0, binding = 3) readonly buffer Labels {
+    uint labels[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 mvp;
+    vec2 viewportSize;
+} pc;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragCoord;    // 0..1 across the quad, like gl_PointCoord
+
+// A distinct hue per label id, stepping the hue by the golden ratio
+vec3 labelColor(uint label) {
+    float hue = fract(float(label) * 0.61803398875);
+    return clamp(abs(mod(hue * 6.0 + vec3(0.0, 4.0, 2.0), 6.0) - 3.0) - 1.0, 0.0, 1.0);
+}
+
+void main() {
+    uint point = uint(gl_InstanceIndex);
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+
+    // Offset the corner in clip space so the quad is sizes[point] pixels wide
+    vec3 position = vec3(positions[point * 3], positions[point * 3 + 1], positions[point * 3 + 2]);
+    vec4 center = pc.mvp * vec4(position, 1.0);
+    vec2 offset = (corner - 0.5) * sizes[point] * 2.0 / pc.viewportSize;
+    gl_Position = center + vec4(offset * center.w, 0.0, 0.0);
+
+    fragColor = vec3(colors[point * 3], colors[point * 3 + 1], colors[point * 3 + 2]);
+    // Label 0 is unlabelled and keeps its own color
+    if (HAS_LABELS && labels[point] != 0u) {
+        fragColor = labelColor(labels[point]);
+    }
+    fragCoord = corner;
+}
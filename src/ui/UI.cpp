@@ -1,6 +1,9 @@
 #include "UI.h"
 #include "Renderer.h"
 #include "GridRenderer.h"
+#include "PointCloudRenderer.h"
+#include "PluginContext.h"
+#include "PointCacheWriter.h"
 #include "Config.h"
 #include "Logger.h"
 #include <imgui.h>
@@ -8,6 +11,8 @@
 #include <imgui_impl_vulkan.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cstdio>
+#include <string>
 
 UI::UI(VulkanContext* vulkanContext, Renderer* renderer, Camera* camera)
     : m_vulkanContext(vulkanContext), m_renderer(renderer), m_camera(camera),
@@ -54,7 +59,7 @@ void UI::initImGui() {
     init_info.Device = m_vulkanContext->getDevice();
     init_info.QueueFamily = 0;
     init_info.Queue = m_vulkanContext->getGraphicsQueue();
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = m_vulkanContext->getPipelineCache();
     init_info.DescriptorPool = m_renderer->getDescriptorPool();
     init_info.Allocator = nullptr;
     init_info.RenderPass = m_vulkanContext->getRenderPass();
@@ -125,6 +130,9 @@ void UI::update() {
     Logger::debug("  Drawing control panel...");
     drawControlPanel();
 
+    // 绘制渲染统计
+    drawStatsOverlay();
+
     // 绘制简单的信息窗口
     Logger::debug("  Drawing simple ImGui text...");
     ImGui::Begin("Simple Info");
@@ -140,6 +148,51 @@ void UI::update() {
     Logger::debug("  Exiting UI::update...");
 }
 
+void UI::drawStatsOverlay() {
+    PointCloudRenderer* pointCloudRenderer = m_renderer ? m_renderer->getPointCloudRenderer() : nullptr;
+    if (!pointCloudRenderer) {
+        return;
+    }
+
+    // Top-right corner overlay
+    ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs |
+                                    ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove |
+                                    ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing;
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - 10.0f, viewport->WorkPos.y + 10.0f),
+                            ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.35f);
+    ImGui::Begin("Render Stats", nullptr, window_flags);
+
+    ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+    ImGui::Text("Points: %u / %u", pointCloudRenderer->getDrawnPointCount(), pointCloudRenderer->getPointCount());
+    ImGui::Text("Chunks visible: %u  culled: %u",
+                pointCloudRenderer->getVisibleNodeCount(), pointCloudRenderer->getCulledNodeCount());
+    ImGui::Text("Chunks drawn: %u  draw calls: %u",
+                pointCloudRenderer->getDrawnNodeCount(), pointCloudRenderer->getDrawCallCount());
+    if (pointCloudRenderer->getGpuDrawTimeMs() > 0.0) {
+        ImGui::Text("Point draw: %.2f ms (%s)", pointCloudRenderer->getGpuDrawTimeMs(),
+                    pointCloudRenderer->getDrawPathName());
+    }
+    if (pointCloudRenderer->isPaged()) {
+        ImGui::Text("Chunks resident: %u  evicted: %u",
+                    pointCloudRenderer->getResidentNodeCount(), pointCloudRenderer->getEvictedNodeCount());
+    }
+
+    // GPU memory against the device-local budget, then per category
+    const GpuAllocator& allocator = m_vulkanContext->getAllocator();
+    GpuMemoryBudget budget = allocator.getBudget();
+    ImGui::Text("GPU memory: %.0f / %.0f MB%s", budget.usage / (1024.0 * 1024.0), budget.budget / (1024.0 * 1024.0),
+                budget.fromExtension ? "" : " (estimated)");
+    for (uint32_t i = 0; i < static_cast<uint32_t>(GpuMemoryCategory::Count); i++) {
+        GpuMemoryCategory category = static_cast<GpuMemoryCategory>(i);
+        ImGui::Text("  %s: %.1f MB", getGpuMemoryCategoryName(category),
+                    allocator.getCategoryBytes(category) / (1024.0 * 1024.0));
+    }
+
+    ImGui::End();
+}
+
 void UI::drawCoordinateSystem() {
     // 创建角落窗口用于绘制坐标系视口
     ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoTitleBar | 
@@ -330,11 +383,61 @@ void UI::drawControlPanel() {
     if (ImGui::CollapsingHeader("Display", ImGuiTreeNodeFlags_DefaultOpen)) {
         static bool showGrid = true;
         static bool showAxes = true;
-        static bool showWireframe = false;
+        bool showWireframe = m_renderer && m_renderer->isWireframe();
         
         ImGui::Checkbox("Show Grid", &showGrid);
         ImGui::Checkbox("Show Axes", &showAxes);
-        ImGui::Checkbox("Show Wireframe", &showWireframe);
+        if (ImGui::Checkbox("Show Wireframe", &showWireframe) && m_renderer) {
+            m_renderer->setWireframe(showWireframe);
+        }
+
+        // 点的形状：方形最快，高斯最平滑
+        PointCloudRenderer* pointCloudRenderer = m_renderer ? m_renderer->getPointCloudRenderer() : nullptr;
+        if (pointCloudRenderer) {
+            PointShape currentShape = pointCloudRenderer->getPointShape();
+            if (ImGui::BeginCombo("Point Shape", PointCloudRenderer::getPointShapeName(currentShape))) {
+                for (uint32_t i = 0; i < static_cast<uint32_t>(PointShape::Count); i++) {
+                    PointShape shape = static_cast<PointShape>(i);
+                    if (ImGui::Selectable(PointCloudRenderer::getPointShapeName(shape), shape == currentShape)) {
+                        pointCloudRenderer->setPointShape(shape);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+
+            // 点精灵：实例化四边形绘制，不受设备最大点尺寸限制
+            bool sprites = pointCloudRenderer->isSpritesEnabled();
+            if (ImGui::Checkbox("Point Sprites", &sprites)) {
+                pointCloudRenderer->setSpritesEnabled(sprites);
+            }
+
+            // 顶点拉取：着色器按gl_VertexIndex从存储缓冲区读取各列（含可选的标签列）
+            bool pulling = pointCloudRenderer->isVertexPulling();
+            if (ImGui::Checkbox("Vertex Pulling", &pulling)) {
+                pointCloudRenderer->setVertexPulling(pulling);
+            }
+        }
+    }
+    
+    // 点云缓存
+    if (m_pluginContext && ImGui::CollapsingHeader("Point Cache")) {
+        static char cachePath[512] = "";
+        if (cachePath[0] == '\0') {
+            std::string configured = config.getString("point_cache_file", "points.pcache");
+            snprintf(cachePath, sizeof(cachePath), "%s", configured.c_str());
+        }
+        ImGui::InputText("File", cachePath, sizeof(cachePath));
+        ImGui::Text("Points: %zu", m_pluginContext->getPointCount());
+
+        if (ImGui::Button("Save Cache")) {
+            PointCacheWriter::save(cachePath, *m_pluginContext);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Load Cache")) {
+            if (m_pluginContext->loadPointCache(cachePath)) {
+                config.setString("point_cache_file", cachePath);
+            }
+        }
     }
     
     // 操作说明
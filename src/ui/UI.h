@@ -5,6 +5,7 @@
 
 class Renderer;
 class GridRenderer;
+class PluginContext;
 
 class UI {
 public:
@@ -17,16 +18,19 @@ public:
     VkDescriptorPool getDescriptorPool() const;
 
     void setGridRenderer(GridRenderer* gridRenderer) { m_gridRenderer = gridRenderer; }
+    void setPluginContext(PluginContext* ctx) { m_pluginContext = ctx; }
 
 private:
     void initImGui();
     void drawCoordinateSystem();
     void drawGrid();
     void drawControlPanel();
+    void drawStatsOverlay();
 
     VulkanContext* m_vulkanContext;
     Renderer* m_renderer;
     Camera* m_camera;
     GridRenderer* m_gridRenderer = nullptr;
+    PluginContext* m_pluginContext = nullptr;
     bool m_showControlPanel;
 };
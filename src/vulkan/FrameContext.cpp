@@ -0,0 +1,88 @@
+#include "FrameContext.h"
+#include <stdexcept>
+
+void FrameContext::create(VkDevice device, GpuAllocator& allocator, VkCommandPool commandPool,
+                          VkDeviceSize uploadArenaSize) {
+    m_device = device;
+    m_allocator = &allocator;
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(m_device, &allocInfo, &m_commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate command buffers!");
+    }
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    if (vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_imageAvailableSemaphore) != VK_SUCCESS ||
+        vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_renderFinishedSemaphore) != VK_SUCCESS ||
+        vkCreateFence(m_device, &fenceInfo, nullptr, &m_inFlightFence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create sync objects!");
+    }
+
+    if (uploadArenaSize == 0) {
+        return;
+    }
+
+    allocator.createBuffer(uploadArenaSize,
+                           VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                           VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                           m_uploadBuffer, m_uploadMemory, GpuMemoryCategory::Staging);
+    m_uploadMapped = static_cast<uint8_t*>(m_uploadMemory.mapped);
+    m_uploadSize = uploadArenaSize;
+    m_uploadOffset = 0;
+}
+
+void FrameContext::destroy(VkCommandPool commandPool) {
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    reset();
+
+    m_allocator->destroyBuffer(m_uploadBuffer, m_uploadMemory);
+    vkDestroySemaphore(m_device, m_renderFinishedSemaphore, nullptr);
+    vkDestroySemaphore(m_device, m_imageAvailableSemaphore, nullptr);
+    vkDestroyFence(m_device, m_inFlightFence, nullptr);
+    if (m_commandBuffer != VK_NULL_HANDLE) {
+        vkFreeCommandBuffers(m_device, commandPool, 1, &m_commandBuffer);
+    }
+
+    *this = FrameContext();
+}
+
+void FrameContext::reset() {
+    // Deleters may defer further objects; those run on the next reset
+    std::vector<std::function<void()>> deletionQueue;
+    deletionQueue.swap(m_deletionQueue);
+    for (auto& deleter : deletionQueue) {
+        deleter();
+    }
+    m_uploadOffset = 0;
+}
+
+bool FrameContext::allocateUpload(VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation) {
+    if (alignment == 0) {
+        alignment = 1;
+    }
+    VkDeviceSize offset = (m_uploadOffset + alignment - 1) / alignment * alignment;
+    if (m_uploadMapped == nullptr || offset + size > m_uploadSize) {
+        return false;
+    }
+
+    allocation.buffer = m_uploadBuffer;
+    allocation.offset = offset;
+    allocation.data = m_uploadMapped + offset;
+    m_uploadOffset = offset + size;
+    return true;
+}
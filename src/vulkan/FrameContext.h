@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <vector>
+#include "GpuAllocator.h"
+
+// Resources owned by one slot of the frames-in-flight ring. A slot is reused
+// only after its fence has signalled, so everything in it can be recycled
+// without further synchronization:
+//   - the primary command buffer and the frame's sync objects
+//   - a transient upload arena (host-visible, persistently mapped) that is
+//     linearly sub-allocated during the frame and rewound when the slot
+//     comes around again
+//   - a deferred-delete list for objects the frame may still reference
+class FrameContext {
+public:
+    // Sub-allocation of the upload arena
+    struct Allocation {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        void* data = nullptr;
+    };
+
+    FrameContext() = default;
+    ~FrameContext() = default;
+
+    // Throws std::runtime_error on failure
+    void create(VkDevice device, GpuAllocator& allocator, VkCommandPool commandPool,
+                VkDeviceSize uploadArenaSize);
+    // Runs the pending deferred deletes and destroys the slot's objects
+    void destroy(VkCommandPool commandPool);
+
+    // Called once the slot's fence has been waited on
+    void reset();
+
+    // Returns false if the arena is exhausted for this frame
+    bool allocateUpload(VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation);
+    // Run deleter when this slot is next reset, i.e. after this frame and all
+    // frames submitted before it have completed on the GPU
+    void deferDelete(std::function<void()> deleter) { m_deletionQueue.push_back(std::move(deleter)); }
+
+    VkCommandBuffer getCommandBuffer() const { return m_commandBuffer; }
+    VkFence getInFlightFence() const { return m_inFlightFence; }
+    VkSemaphore getImageAvailableSemaphore() const { return m_imageAvailableSemaphore; }
+    VkSemaphore getRenderFinishedSemaphore() const { return m_renderFinishedSemaphore; }
+    VkDeviceSize getUploadArenaSize() const { return m_uploadSize; }
+    VkDeviceSize getUploadArenaUsed() const { return m_uploadOffset; }
+
+private:
+    VkDevice m_device = VK_NULL_HANDLE;
+    GpuAllocator* m_allocator = nullptr;
+
+    VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+    VkFence m_inFlightFence = VK_NULL_HANDLE;
+    VkSemaphore m_imageAvailableSemaphore = VK_NULL_HANDLE;
+    VkSemaphore m_renderFinishedSemaphore = VK_NULL_HANDLE;
+
+    VkBuffer m_uploadBuffer = VK_NULL_HANDLE;
+    GpuAllocation m_uploadMemory;
+    uint8_t* m_uploadMapped = nullptr;
+    VkDeviceSize m_uploadSize = 0;
+    VkDeviceSize m_uploadOffset = 0;
+
+    std::vector<std::function<void()>> m_deletionQueue;
+};
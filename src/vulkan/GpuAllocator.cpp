@@ -0,0 +1,391 @@
+#include "GpuAllocator.h"
+#include "Logger.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+// Share of a heap assumed to be available without VK_EXT_memory_budget
+const VkDeviceSize ESTIMATED_BUDGET_PERCENT = 80;
+
+} // namespace
+
+const char* getGpuMemoryCategoryName(GpuMemoryCategory category) {
+    switch (category) {
+    case GpuMemoryCategory::Points: return "Points";
+    case GpuMemoryCategory::Images: return "Images";
+    case GpuMemoryCategory::Geometry: return "Geometry";
+    case GpuMemoryCategory::Staging: return "Staging";
+    default: return "Other";
+    }
+}
+
+GpuAllocator::GpuAllocator()
+    : m_device(VK_NULL_HANDLE), m_physicalDevice(VK_NULL_HANDLE), m_memoryProperties{},
+      m_getMemoryProperties2(nullptr), m_budgetLimit(0), m_blockSize(DEFAULT_BLOCK_SIZE),
+      m_dedicatedCount(0), m_dedicatedBytes(0), m_usedBytes(0), m_heapBytes{}, m_categoryBytes{},
+      m_overBudget{} {}
+
+GpuAllocator::~GpuAllocator() {
+    cleanup();
+}
+
+void GpuAllocator::init(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize) {
+    m_device = device;
+    m_physicalDevice = physicalDevice;
+    m_blockSize = blockSize > 0 ? blockSize : DEFAULT_BLOCK_SIZE;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memoryProperties);
+    Logger::info("GPU allocator: {} MB blocks, {} memory types", m_blockSize / (1024 * 1024),
+                 m_memoryProperties.memoryTypeCount);
+}
+
+void GpuAllocator::enableMemoryBudget(VkInstance instance) {
+    m_getMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(
+        vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+    if (!m_getMemoryProperties2) {
+        Logger::warn("vkGetPhysicalDeviceMemoryProperties2KHR unavailable, estimating memory budgets");
+    }
+}
+
+void GpuAllocator::cleanup() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    uint32_t leaked = m_dedicatedCount;
+    for (auto& block : m_blocks) {
+        if (block.memory == VK_NULL_HANDLE) {
+            continue;
+        }
+        leaked += block.allocationCount;
+        // Freeing the memory implicitly unmaps it
+        vkFreeMemory(m_device, block.memory, nullptr);
+    }
+    if (leaked > 0) {
+        Logger::warn("GPU allocator: {} allocations still alive at cleanup", leaked);
+    }
+
+    m_blocks.clear();
+    m_dedicatedCount = 0;
+    m_dedicatedBytes = 0;
+    m_usedBytes = 0;
+    std::fill(std::begin(m_heapBytes), std::end(m_heapBytes), 0);
+    std::fill(std::begin(m_categoryBytes), std::end(m_categoryBytes), 0);
+    m_device = VK_NULL_HANDLE;
+}
+
+uint32_t GpuAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for (uint32_t type = 0; type < m_memoryProperties.memoryTypeCount; type++) {
+        if ((typeFilter & (1 << type)) &&
+            (m_memoryProperties.memoryTypes[type].propertyFlags & properties) == properties) {
+            return type;
+        }
+    }
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+GpuAllocation GpuAllocator::allocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties,
+                                           GpuMemoryCategory category) {
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(m_device, buffer, &requirements);
+    GpuAllocation allocation = allocate(requirements, properties, true, category);
+    if (vkBindBufferMemory(m_device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS) {
+        free(allocation);
+        throw std::runtime_error("Failed to bind buffer memory!");
+    }
+    return allocation;
+}
+
+GpuAllocation GpuAllocator::allocateImage(VkImage image, VkMemoryPropertyFlags properties,
+                                          GpuMemoryCategory category) {
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(m_device, image, &requirements);
+    GpuAllocation allocation = allocate(requirements, properties, false, category);
+    if (vkBindImageMemory(m_device, image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+        free(allocation);
+        throw std::runtime_error("Failed to bind image memory!");
+    }
+    return allocation;
+}
+
+GpuAllocation GpuAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+                                     bool linear, GpuMemoryCategory category) {
+    uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+    bool hostVisible = (m_memoryProperties.memoryTypes[memoryType].propertyFlags &
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    GpuAllocation allocation;
+    allocation.size = requirements.size;
+    allocation.m_heap = m_memoryProperties.memoryTypes[memoryType].heapIndex;
+    allocation.m_category = category;
+
+    // Large resources get their own memory object
+    if (requirements.size > m_blockSize / 2) {
+        void* mapped = nullptr;
+        allocation.memory = allocateDeviceMemory(requirements.size, memoryType, hostVisible ? &mapped : nullptr);
+        allocation.mapped = mapped;
+        m_dedicatedCount++;
+        m_dedicatedBytes += requirements.size;
+        m_usedBytes += requirements.size;
+        m_categoryBytes[static_cast<uint32_t>(category)] += requirements.size;
+        checkBudget(allocation.m_heap);
+        return allocation;
+    }
+
+    VkDeviceSize offset = 0;
+    uint32_t blockIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < m_blocks.size(); i++) {
+        Block& block = m_blocks[i];
+        if (block.memory != VK_NULL_HANDLE && block.memoryType == memoryType && block.linear == linear &&
+            allocateFromBlock(block, requirements.size, requirements.alignment, offset)) {
+            blockIndex = i;
+            break;
+        }
+    }
+
+    if (blockIndex == UINT32_MAX) {
+        Block block;
+        void* mapped = nullptr;
+        block.memory = allocateDeviceMemory(m_blockSize, memoryType, hostVisible ? &mapped : nullptr);
+        block.size = m_blockSize;
+        block.memoryType = memoryType;
+        block.linear = linear;
+        block.mapped = static_cast<uint8_t*>(mapped);
+        block.freeRanges.push_back({ 0, m_blockSize });
+        allocateFromBlock(block, requirements.size, requirements.alignment, offset);
+
+        // Reuse the slot of a released block
+        auto unused = std::find_if(m_blocks.begin(), m_blocks.end(),
+                                   [](const Block& b) { return b.memory == VK_NULL_HANDLE; });
+        if (unused != m_blocks.end()) {
+            *unused = std::move(block);
+            blockIndex = static_cast<uint32_t>(unused - m_blocks.begin());
+        } else {
+            m_blocks.push_back(std::move(block));
+            blockIndex = static_cast<uint32_t>(m_blocks.size() - 1);
+        }
+        Logger::debug("GPU allocator: new {} block {} for memory type {}",
+                      linear ? "buffer" : "image", blockIndex, memoryType);
+        checkBudget(allocation.m_heap);
+    }
+
+    Block& block = m_blocks[blockIndex];
+    block.allocationCount++;
+    m_usedBytes += requirements.size;
+    m_categoryBytes[static_cast<uint32_t>(category)] += requirements.size;
+
+    allocation.memory = block.memory;
+    allocation.offset = offset;
+    allocation.mapped = block.mapped ? block.mapped + offset : nullptr;
+    allocation.m_block = blockIndex;
+    return allocation;
+}
+
+void GpuAllocator::free(GpuAllocation& allocation) {
+    if (!allocation.isValid()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_usedBytes -= allocation.size;
+    m_categoryBytes[static_cast<uint32_t>(allocation.m_category)] -= allocation.size;
+
+    if (allocation.m_block == UINT32_MAX) {
+        vkFreeMemory(m_device, allocation.memory, nullptr);
+        m_heapBytes[allocation.m_heap] -= allocation.size;
+        m_dedicatedCount--;
+        m_dedicatedBytes -= allocation.size;
+    } else {
+        Block& block = m_blocks[allocation.m_block];
+        releaseRange(block, allocation.offset, allocation.size);
+        block.allocationCount--;
+
+        // Give an empty block back unless it is the last one of its kind
+        if (block.allocationCount == 0) {
+            bool hasSibling = false;
+            for (const auto& other : m_blocks) {
+                if (&other != &block && other.memory != VK_NULL_HANDLE &&
+                    other.memoryType == block.memoryType && other.linear == block.linear) {
+                    hasSibling = true;
+                    break;
+                }
+            }
+            if (hasSibling) {
+                vkFreeMemory(m_device, block.memory, nullptr);
+                m_heapBytes[allocation.m_heap] -= block.size;
+                block = Block();
+            }
+        }
+    }
+
+    allocation = GpuAllocation();
+}
+
+void GpuAllocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                                VkBuffer& buffer, GpuAllocation& allocation, GpuMemoryCategory category) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create buffer!");
+    }
+
+    try {
+        allocation = allocateBuffer(buffer, properties, category);
+    } catch (...) {
+        vkDestroyBuffer(m_device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+        throw;
+    }
+}
+
+void GpuAllocator::destroyBuffer(VkBuffer& buffer, GpuAllocation& allocation) {
+    if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+    }
+    free(allocation);
+}
+
+uint32_t GpuAllocator::getDeviceAllocationCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t count = m_dedicatedCount;
+    for (const auto& block : m_blocks) {
+        if (block.memory != VK_NULL_HANDLE) {
+            count++;
+        }
+    }
+    return count;
+}
+
+VkDeviceSize GpuAllocator::getAllocatedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    VkDeviceSize bytes = m_dedicatedBytes;
+    for (const auto& block : m_blocks) {
+        if (block.memory != VK_NULL_HANDLE) {
+            bytes += block.size;
+        }
+    }
+    return bytes;
+}
+
+VkDeviceSize GpuAllocator::getUsedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_usedBytes;
+}
+
+VkDeviceSize GpuAllocator::getCategoryBytes(GpuMemoryCategory category) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return category < GpuMemoryCategory::Count ? m_categoryBytes[static_cast<uint32_t>(category)] : 0;
+}
+
+GpuMemoryBudget GpuAllocator::getBudget(VkMemoryPropertyFlags properties) const {
+    uint32_t heap = m_memoryProperties.memoryTypes[findMemoryType(~0u, properties)].heapIndex;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return getHeapBudget(heap);
+}
+
+GpuMemoryBudget GpuAllocator::getHeapBudget(uint32_t heap) const {
+    GpuMemoryBudget budget;
+    if (m_getMemoryProperties2) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+        budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        VkPhysicalDeviceMemoryProperties2KHR properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = &budgetProperties;
+        m_getMemoryProperties2(m_physicalDevice, &properties);
+
+        budget.budget = budgetProperties.heapBudget[heap];
+        budget.usage = budgetProperties.heapUsage[heap];
+        budget.fromExtension = true;
+    } else {
+        budget.budget = m_memoryProperties.memoryHeaps[heap].size / 100 * ESTIMATED_BUDGET_PERCENT;
+        budget.usage = m_heapBytes[heap];
+    }
+    if (m_budgetLimit > 0) {
+        budget.budget = (std::min)(budget.budget, m_budgetLimit);
+    }
+    return budget;
+}
+
+void GpuAllocator::checkBudget(uint32_t heap) {
+    GpuMemoryBudget budget = getHeapBudget(heap);
+    bool overBudget = budget.usage > budget.budget;
+    if (overBudget && !m_overBudget[heap]) {
+        Logger::warn("GPU memory heap {} over budget: {} MB used of {} MB", heap,
+                     budget.usage / (1024 * 1024), budget.budget / (1024 * 1024));
+    }
+    m_overBudget[heap] = overBudget;
+}
+
+VkDeviceMemory GpuAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, void** mapped) {
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(m_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate device memory!");
+    }
+    if (mapped && vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS) {
+        vkFreeMemory(m_device, memory, nullptr);
+        throw std::runtime_error("Failed to map device memory!");
+    }
+    m_heapBytes[m_memoryProperties.memoryTypes[memoryType].heapIndex] += size;
+    return memory;
+}
+
+bool GpuAllocator::allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+    for (size_t i = 0; i < block.freeRanges.size(); i++) {
+        Range range = block.freeRanges[i];
+        VkDeviceSize alignedOffset = alignUp(range.offset, alignment);
+        if (alignedOffset + size > range.offset + range.size) {
+            continue;
+        }
+
+        // Split off the alignment padding in front and the remainder behind
+        VkDeviceSize end = alignedOffset + size;
+        VkDeviceSize rangeEnd = range.offset + range.size;
+        block.freeRanges.erase(block.freeRanges.begin() + i);
+        if (end < rangeEnd) {
+            block.freeRanges.insert(block.freeRanges.begin() + i, { end, rangeEnd - end });
+        }
+        if (alignedOffset > range.offset) {
+            block.freeRanges.insert(block.freeRanges.begin() + i, { range.offset, alignedOffset - range.offset });
+        }
+        offset = alignedOffset;
+        return true;
+    }
+    return false;
+}
+
+void GpuAllocator::releaseRange(Block& block, VkDeviceSize offset, VkDeviceSize size) {
+    auto next = std::lower_bound(block.freeRanges.begin(), block.freeRanges.end(), offset,
+                                 [](const Range& range, VkDeviceSize value) { return range.offset < value; });
+    auto inserted = block.freeRanges.insert(next, { offset, size });
+
+    // Merge with the following and the preceding range
+    auto following = inserted + 1;
+    if (following != block.freeRanges.end() && inserted->offset + inserted->size == following->offset) {
+        inserted->size += following->size;
+        block.freeRanges.erase(following);
+    }
+    if (inserted != block.freeRanges.begin()) {
+        auto preceding = inserted - 1;
+        if (preceding->offset + preceding->size == inserted->offset) {
+            preceding->size += inserted->size;
+            block.freeRanges.erase(inserted);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// What an allocation is used for; tracked for the memory budget statistics
+enum class GpuMemoryCategory : uint32_t {
+    Points = 0,     // point cloud vertices and culling buffers
+    Images,         // render targets, depth buffers and transient images
+    Geometry,       // grid, axes and demo object meshes
+    Staging,        // upload ring, upload arenas and readback buffers
+    Other,
+    Count
+};
+
+const char* getGpuMemoryCategoryName(GpuMemoryCategory category);
+
+// Memory budget of a heap. With VK_EXT_memory_budget both values come from
+// the driver and include other processes' pressure; otherwise the budget is
+// estimated as a fraction of the heap size and the usage is this allocator's.
+struct GpuMemoryBudget {
+    VkDeviceSize budget = 0;
+    VkDeviceSize usage = 0;
+    bool fromExtension = false;
+};
+
+// A sub-allocated range of device memory. Host-visible memory is mapped once
+// per block, so 'mapped' points at the start of the allocation for the whole
+// lifetime of the allocation; never call vkMapMemory on 'memory'.
+struct GpuAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void* mapped = nullptr;
+
+    bool isValid() const { return memory != VK_NULL_HANDLE; }
+
+private:
+    friend class GpuAllocator;
+    uint32_t m_block = UINT32_MAX;  // UINT32_MAX: dedicated allocation
+    uint32_t m_heap = 0;
+    GpuMemoryCategory m_category = GpuMemoryCategory::Other;
+};
+
+// Central device memory allocator. Memory is allocated from the driver in
+// large blocks per memory type and handed out by first-fit over a sorted
+// free list, so the number of vkAllocateMemory calls stays far below
+// maxMemoryAllocationCount. Buffers and images live in separate blocks,
+// which keeps linear and optimal resources apart (bufferImageGranularity).
+// Requests larger than half a block get a dedicated allocation.
+//
+// All functions are thread-safe; allocate*() throw std::runtime_error on failure.
+class GpuAllocator {
+public:
+    static const VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+    GpuAllocator();
+    ~GpuAllocator();
+
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+    // Query budgets through VK_EXT_memory_budget; the device must have been
+    // created with the extension (and the instance with
+    // VK_KHR_get_physical_device_properties2)
+    void enableMemoryBudget(VkInstance instance);
+    // Cap every heap's budget (0: no cap)
+    void setBudgetLimit(VkDeviceSize limit) { m_budgetLimit = limit; }
+    // Frees every block; all allocations must have been freed
+    void cleanup();
+
+    // Uses the memory properties queried once in init()
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+    // Allocate memory for the buffer or image and bind it
+    GpuAllocation allocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties,
+                                 GpuMemoryCategory category = GpuMemoryCategory::Other);
+    GpuAllocation allocateImage(VkImage image, VkMemoryPropertyFlags properties,
+                                GpuMemoryCategory category = GpuMemoryCategory::Images);
+    // Allocate without binding; 'linear' selects buffer (true) or image (false) blocks
+    GpuAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear,
+                           GpuMemoryCategory category = GpuMemoryCategory::Other);
+    // Return the range to its block; resets the allocation
+    void free(GpuAllocation& allocation);
+
+    // Create a buffer with bound memory; throws std::runtime_error on failure
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                      VkBuffer& buffer, GpuAllocation& allocation,
+                      GpuMemoryCategory category = GpuMemoryCategory::Other);
+    // Destroy a buffer created with createBuffer() and free its memory
+    void destroyBuffer(VkBuffer& buffer, GpuAllocation& allocation);
+
+    // Statistics
+    uint32_t getDeviceAllocationCount() const;
+    VkDeviceSize getAllocatedBytes() const;
+    VkDeviceSize getUsedBytes() const;
+    VkDeviceSize getCategoryBytes(GpuMemoryCategory category) const;
+    // Budget of the heap that memory with 'properties' is allocated from
+    GpuMemoryBudget getBudget(VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) const;
+
+private:
+    struct Range {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    struct Block {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        uint32_t memoryType = 0;
+        bool linear = true;
+        uint8_t* mapped = nullptr;
+        uint32_t allocationCount = 0;
+        // Sorted by offset, adjacent ranges merged
+        std::vector<Range> freeRanges;
+    };
+
+    VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, void** mapped);
+    GpuMemoryBudget getHeapBudget(uint32_t heap) const;
+    // Warn once each time a heap goes over its budget; m_mutex must be held
+    void checkBudget(uint32_t heap);
+    bool allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+    void releaseRange(Block& block, VkDeviceSize offset, VkDeviceSize size);
+
+    VkDevice m_device;
+    VkPhysicalDevice m_physicalDevice;
+    VkPhysicalDeviceMemoryProperties m_memoryProperties;
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR m_getMemoryProperties2;
+    VkDeviceSize m_budgetLimit;
+    VkDeviceSize m_blockSize;
+    // Freed blocks stay in place (memory == VK_NULL_HANDLE) so block indices remain valid
+    std::vector<Block> m_blocks;
+    uint32_t m_dedicatedCount;
+    VkDeviceSize m_dedicatedBytes;
+    VkDeviceSize m_usedBytes;
+    // Device memory allocated from each heap and bytes handed out per category
+    VkDeviceSize m_heapBytes[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize m_categoryBytes[static_cast<uint32_t>(GpuMemoryCategory::Count)];
+    bool m_overBudget[VK_MAX_MEMORY_HEAPS];
+    mutable std::mutex m_mutex;
+};
@@ -0,0 +1,274 @@
+#include "PipelineBuilder.h"
+#include "Logger.h"
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+void hashCombine(size_t& seed, uint64_t value) {
+    seed ^= std::hash<uint64_t>()(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+// Specialization info for one stage: element i of 'constants' is constant_id i
+struct StageSpecialization {
+    std::vector<VkSpecializationMapEntry> entries;
+    VkSpecializationInfo info{};
+
+    explicit StageSpecialization(const std::vector<uint32_t>& constants) : entries(constants.size()) {
+        for (size_t i = 0; i < entries.size(); i++) {
+            entries[i].constantID = static_cast<uint32_t>(i);
+            entries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+            entries[i].size = sizeof(uint32_t);
+        }
+        info.mapEntryCount = static_cast<uint32_t>(entries.size());
+        info.pMapEntries = entries.data();
+        info.dataSize = constants.size() * sizeof(uint32_t);
+        info.pData = constants.data();
+    }
+
+    const VkSpecializationInfo* get() const { return entries.empty() ? nullptr : &info; }
+};
+
+template <typename Handle>
+uint64_t handleValue(Handle handle) {
+    return (uint64_t)(handle);
+}
+
+} // namespace
+
+bool PipelineKey::operator==(const PipelineKey& other) const {
+    if (vertexShader != other.vertexShader || fragmentShader != other.fragmentShader ||
+        layout != other.layout || renderPass != other.renderPass ||
+        topology != other.topology || polygonMode != other.polygonMode ||
+        cullMode != other.cullMode || frontFace != other.frontFace ||
+        depthTest != other.depthTest || depthWrite != other.depthWrite || blendMode != other.blendMode ||
+        bindings.size() != other.bindings.size() || attributes.size() != other.attributes.size() ||
+        vertexConstants != other.vertexConstants || fragmentConstants != other.fragmentConstants) {
+        return false;
+    }
+    for (size_t i = 0; i < bindings.size(); i++) {
+        const VkVertexInputBindingDescription& a = bindings[i];
+        const VkVertexInputBindingDescription& b = other.bindings[i];
+        if (a.binding != b.binding || a.stride != b.stride || a.inputRate != b.inputRate) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < attributes.size(); i++) {
+        const VkVertexInputAttributeDescription& a = attributes[i];
+        const VkVertexInputAttributeDescription& b = other.attributes[i];
+        if (a.location != b.location || a.binding != b.binding || a.format != b.format || a.offset != b.offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t PipelineKey::hash() const {
+    size_t seed = 0;
+    hashCombine(seed, handleValue(vertexShader));
+    hashCombine(seed, handleValue(fragmentShader));
+    hashCombine(seed, handleValue(layout));
+    hashCombine(seed, handleValue(renderPass));
+    for (const auto& binding : bindings) {
+        hashCombine(seed, (static_cast<uint64_t>(binding.binding) << 32) | binding.stride);
+        hashCombine(seed, static_cast<uint64_t>(binding.inputRate));
+    }
+    for (const auto& attribute : attributes) {
+        hashCombine(seed, (static_cast<uint64_t>(attribute.location) << 32) | attribute.binding);
+        hashCombine(seed, (static_cast<uint64_t>(attribute.format) << 32) | attribute.offset);
+    }
+    hashCombine(seed, static_cast<uint64_t>(topology));
+    hashCombine(seed, static_cast<uint64_t>(polygonMode));
+    hashCombine(seed, static_cast<uint64_t>(cullMode));
+    hashCombine(seed, static_cast<uint64_t>(frontFace));
+    hashCombine(seed, (depthTest ? 1u : 0u) | (depthWrite ? 2u : 0u));
+    hashCombine(seed, static_cast<uint64_t>(blendMode));
+    hashCombine(seed, vertexConstants.size());
+    for (uint32_t constant : vertexConstants) {
+        hashCombine(seed, constant);
+    }
+    for (uint32_t constant : fragmentConstants) {
+        hashCombine(seed, constant);
+    }
+    return seed;
+}
+
+PipelineBuilder::PipelineBuilder()
+    : m_device(VK_NULL_HANDLE), m_pipelineCache(VK_NULL_HANDLE), m_buildCount(0), m_hitCount(0) {}
+
+PipelineBuilder::~PipelineBuilder() {
+    cleanup();
+}
+
+void PipelineBuilder::init(VkDevice device, VkPipelineCache pipelineCache) {
+    m_device = device;
+    m_pipelineCache = pipelineCache;
+}
+
+void PipelineBuilder::cleanup() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& entry : m_pipelines) {
+        vkDestroyPipeline(m_device, entry.second, nullptr);
+    }
+    if (!m_pipelines.empty()) {
+        Logger::debug("Destroyed {} pipelines ({} built, {} reused)", m_pipelines.size(), m_buildCount, m_hitCount);
+    }
+    m_pipelines.clear();
+}
+
+VkPipeline PipelineBuilder::getPipeline(const PipelineKey& key) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_pipelines.find(key);
+        if (it != m_pipelines.end()) {
+            m_hitCount++;
+            return it->second;
+        }
+    }
+
+    VkPipeline pipeline = build(key);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto inserted = m_pipelines.emplace(key, pipeline);
+    if (!inserted.second) {
+        // Another thread built the same pipeline meanwhile
+        vkDestroyPipeline(m_device, pipeline, nullptr);
+        m_hitCount++;
+        return inserted.first->second;
+    }
+    m_buildCount++;
+    return pipeline;
+}
+
+void PipelineBuilder::destroyPipelines(VkShaderModule shader) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_pipelines.begin(); it != m_pipelines.end();) {
+        if (it->first.vertexShader == shader || it->first.fragmentShader == shader) {
+            vkDestroyPipeline(m_device, it->second, nullptr);
+            it = m_pipelines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+uint32_t PipelineBuilder::getPipelineCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<uint32_t>(m_pipelines.size());
+}
+
+uint64_t PipelineBuilder::getBuildCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_buildCount;
+}
+
+uint64_t PipelineBuilder::getHitCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hitCount;
+}
+
+VkPipeline PipelineBuilder::build(const PipelineKey& key) const {
+    VkPipelineShaderStageCreateInfo shaderStages[2]{};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = key.vertexShader;
+    shaderStages[0].pName = "main";
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = key.fragmentShader;
+    shaderStages[1].pName = "main";
+
+    StageSpecialization vertexSpecialization(key.vertexConstants);
+    StageSpecialization fragmentSpecialization(key.fragmentConstants);
+    shaderStages[0].pSpecializationInfo = vertexSpecialization.get();
+    shaderStages[1].pSpecializationInfo = fragmentSpecialization.get();
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(key.bindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = key.bindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(key.attributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = key.attributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = key.topology;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = key.polygonMode;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = key.cullMode;
+    rasterizer.frontFace = key.frontFace;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = key.depthTest ? VK_TRUE : VK_FALSE;
+    depthStencil.depthWriteEnable = key.depthWrite ? VK_TRUE : VK_FALSE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                          VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_FALSE;
+    if (key.blendMode == PipelineBlendMode::Alpha) {
+        colorBlendAttachment.blendEnable = VK_TRUE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    }
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = key.layout;
+    pipelineInfo.renderPass = key.renderPass;
+    pipelineInfo.subpass = 0;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create graphics pipeline!");
+    }
+    return pipeline;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+enum class PipelineBlendMode : uint32_t {
+    None = 0,
+    Alpha       // src * srcAlpha + dst * (1 - srcAlpha)
+};
+
+// Everything that distinguishes one graphics pipeline from another. Viewport
+// and scissor are always dynamic, rasterization is single-sampled and the
+// pipeline targets subpass 0. Handles are part of the key, so a pipeline is
+// only shared between users of the same shaders, layout and render pass.
+struct PipelineKey {
+    VkShaderModule vertexShader = VK_NULL_HANDLE;
+    VkShaderModule fragmentShader = VK_NULL_HANDLE;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+
+    std::vector<VkVertexInputBindingDescription> bindings;
+    std::vector<VkVertexInputAttributeDescription> attributes;
+
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_NONE;
+    VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    bool depthTest = true;
+    bool depthWrite = true;
+    PipelineBlendMode blendMode = PipelineBlendMode::None;
+
+    // Specialization constants per stage: element i is the 32-bit value of constant_id i
+    std::vector<uint32_t> vertexConstants;
+    std::vector<uint32_t> fragmentConstants;
+
+    bool operator==(const PipelineKey& other) const;
+    size_t hash() const;
+};
+
+// Builds graphics pipelines from PipelineKeys and keeps them, so a variant
+// requested again (by the same or another renderer) is looked up instead of
+// rebuilt. Pipelines are created through the shared VkPipelineCache and are
+// owned by the builder: users must not destroy them.
+//
+// Thread-safe; pipelines are created outside the lock so renderers can build
+// concurrently. getPipeline() throws std::runtime_error on failure.
+class PipelineBuilder {
+public:
+    PipelineBuilder();
+    ~PipelineBuilder();
+
+    void init(VkDevice device, VkPipelineCache pipelineCache);
+    // Destroys every pipeline
+    void cleanup();
+
+    VkPipeline getPipeline(const PipelineKey& key);
+    // Destroy the pipelines built from 'shader'; call before destroying the
+    // module, so a later module reusing the handle does not match them
+    void destroyPipelines(VkShaderModule shader);
+
+    // Statistics
+    uint32_t getPipelineCount() const;
+    uint64_t getBuildCount() const;
+    uint64_t getHitCount() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const PipelineKey& key) const { return key.hash(); }
+    };
+
+    VkPipeline build(const PipelineKey& key) const;
+
+    VkDevice m_device;
+    VkPipelineCache m_pipelineCache;
+    std::unordered_map<PipelineKey, VkPipeline, KeyHash> m_pipelines;
+    uint64_t m_buildCount;
+    uint64_t m_hitCount;
+    mutable std::mutex m_mutex;
+};
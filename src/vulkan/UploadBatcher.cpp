@@ -0,0 +1,246 @@
+#include "UploadBatcher.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+UploadBatcher::UploadBatcher()
+    : m_device(VK_NULL_HANDLE), m_queue(VK_NULL_HANDLE), m_allocator(nullptr), m_commandPool(VK_NULL_HANDLE),
+      m_ringBuffer(VK_NULL_HANDLE), m_ringMapped(nullptr), m_ringSize(0), m_head(0), m_tail(0),
+      m_submitCount(0) {}
+
+UploadBatcher::~UploadBatcher() {
+    destroy();
+}
+
+void UploadBatcher::create(VkDevice device, VkQueue queue, uint32_t queueFamily, GpuAllocator& allocator,
+                           VkDeviceSize ringSize) {
+    m_device = device;
+    m_queue = queue;
+    m_allocator = &allocator;
+    m_ringSize = alignUp((std::max)(ringSize, STAGING_ALIGNMENT), STAGING_ALIGNMENT);
+    m_head = 0;
+    m_tail = 0;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+    if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create upload command pool!");
+    }
+
+    allocator.createBuffer(m_ringSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                           m_ringBuffer, m_ringMemory, GpuMemoryCategory::Staging);
+    m_ringMapped = static_cast<uint8_t*>(m_ringMemory.mapped);
+
+    Logger::debug("Upload staging ring: {} KB", m_ringSize / 1024);
+}
+
+void UploadBatcher::destroy() {
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (!m_pending.empty()) {
+        Logger::debug("Dropping {} unflushed uploads", m_pending.size());
+        m_pending.clear();
+    }
+
+    std::vector<VkFence> fences;
+    for (const auto& batch : m_inFlight) {
+        fences.push_back(batch.fence);
+    }
+    if (!fences.empty()) {
+        vkWaitForFences(m_device, static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
+    }
+    for (const auto& batch : m_inFlight) {
+        vkDestroyFence(m_device, batch.fence, nullptr);
+    }
+    for (const auto& batch : m_freeBatches) {
+        vkDestroyFence(m_device, batch.fence, nullptr);
+    }
+    m_inFlight.clear();
+    m_freeBatches.clear();
+
+    // Destroying the pool frees the command buffers
+    if (m_commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        m_commandPool = VK_NULL_HANDLE;
+    }
+    m_allocator->destroyBuffer(m_ringBuffer, m_ringMemory);
+    m_ringMapped = nullptr;
+    m_device = VK_NULL_HANDLE;
+}
+
+void UploadBatcher::upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    // Chunks of at most half the ring keep the next chunk from waiting on the current one
+    VkDeviceSize maxChunk = (std::max)(m_ringSize / 2, STAGING_ALIGNMENT);
+
+    while (size > 0) {
+        VkDeviceSize chunk = (std::min)(size, maxChunk);
+        VkDeviceSize ringOffset = reserve(chunk);
+        std::memcpy(m_ringMapped + ringOffset, bytes, static_cast<size_t>(chunk));
+
+        PendingCopy copy;
+        copy.dst = dst;
+        copy.region.srcOffset = ringOffset;
+        copy.region.dstOffset = dstOffset;
+        copy.region.size = chunk;
+        m_pending.push_back(copy);
+
+        bytes += chunk;
+        dstOffset += chunk;
+        size -= chunk;
+    }
+}
+
+void UploadBatcher::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    flushLocked();
+}
+
+bool UploadBatcher::hasPendingUploads() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_pending.empty();
+}
+
+void UploadBatcher::flushLocked() {
+    if (m_pending.empty()) {
+        return;
+    }
+
+    Batch batch = acquireBatch();
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(batch.commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin upload command buffer!");
+    }
+
+    // Earlier submissions may still read the destinations (write after read)
+    vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    // One copy command per run of copies into the same buffer
+    std::vector<VkBufferCopy> regions;
+    for (size_t i = 0; i < m_pending.size(); i++) {
+        regions.push_back(m_pending[i].region);
+        if (i + 1 == m_pending.size() || m_pending[i + 1].dst != m_pending[i].dst) {
+            vkCmdCopyBuffer(batch.commandBuffer, m_ringBuffer, m_pending[i].dst,
+                            static_cast<uint32_t>(regions.size()), regions.data());
+            regions.clear();
+        }
+    }
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to end upload command buffer!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+    if (vkQueueSubmit(m_queue, 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+        m_freeBatches.push_back(batch);
+        throw std::runtime_error("Failed to submit upload command buffer!");
+    }
+
+    batch.ringEnd = m_head;
+    m_inFlight.push_back(batch);
+    Logger::debug("Flushed {} uploads ({} KB of staging in flight)", m_pending.size(), getRingUsed() / 1024);
+    m_pending.clear();
+    m_submitCount++;
+}
+
+VkDeviceSize UploadBatcher::reserve(VkDeviceSize size) {
+    retireBatches(false);
+
+    for (;;) {
+        // Nothing queued or in flight: start over at the beginning of the ring
+        if (m_inFlight.empty() && m_pending.empty()) {
+            m_head = 0;
+            m_tail = 0;
+        }
+
+        uint64_t start = alignUp(m_head, STAGING_ALIGNMENT);
+        // A range never wraps around the end of the ring
+        if (start % m_ringSize + size > m_ringSize) {
+            start = alignUp(start, m_ringSize);
+        }
+        if (start + size - m_tail <= m_ringSize) {
+            m_head = start + size;
+            return static_cast<VkDeviceSize>(start % m_ringSize);
+        }
+
+        // The ring is full: submit what is queued and wait for the oldest batch
+        flushLocked();
+        retireBatches(true);
+    }
+}
+
+void UploadBatcher::retireBatches(bool waitForOldest) {
+    while (!m_inFlight.empty()) {
+        Batch& oldest = m_inFlight.front();
+        if (waitForOldest) {
+            vkWaitForFences(m_device, 1, &oldest.fence, VK_TRUE, UINT64_MAX);
+            waitForOldest = false;
+        } else if (vkGetFenceStatus(m_device, oldest.fence) != VK_SUCCESS) {
+            break;
+        }
+        m_tail = oldest.ringEnd;
+        m_freeBatches.push_back(oldest);
+        m_inFlight.pop_front();
+    }
+}
+
+UploadBatcher::Batch UploadBatcher::acquireBatch() {
+    retireBatches(false);
+
+    if (!m_freeBatches.empty()) {
+        Batch batch = m_freeBatches.back();
+        m_freeBatches.pop_back();
+        vkResetFences(m_device, 1, &batch.fence);
+        vkResetCommandBuffer(batch.commandBuffer, 0);
+        return batch;
+    }
+
+    Batch batch;
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = m_commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(m_device, &allocInfo, &batch.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate upload command buffer!");
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(m_device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS) {
+        vkFreeCommandBuffers(m_device, m_commandPool, 1, &batch.commandBuffer);
+        throw std::runtime_error("Failed to create upload fence!");
+    }
+    return batch;
+}
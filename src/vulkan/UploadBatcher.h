@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "GpuAllocator.h"
+
+// Batches buffer uploads through a persistently mapped staging ring.
+//
+// upload() copies the data into the ring right away and queues a copy into
+// the destination; flush() records every queued copy into one command buffer
+// and submits it with its own fence. Ring space is recycled once that fence
+// has signalled, so neither upload() nor flush() waits for the queue to go
+// idle. The renderer flushes once per frame before submitting the frame; the
+// batch ends with a barrier that makes the copies visible to every later
+// submission on the queue.
+//
+// Only an upload that finds the ring full of in-flight data waits, for the
+// oldest batch's fence. upload() and flush() are serialized by a mutex so
+// renderers can initialize on worker threads; create() and destroy() are not.
+class UploadBatcher {
+public:
+    static const VkDeviceSize DEFAULT_RING_SIZE = 16ull * 1024 * 1024;
+
+    UploadBatcher();
+    ~UploadBatcher();
+
+    // Throws std::runtime_error on failure
+    void create(VkDevice device, VkQueue queue, uint32_t queueFamily, GpuAllocator& allocator,
+                VkDeviceSize ringSize = DEFAULT_RING_SIZE);
+    // Waits for the in-flight batches; queued uploads that were never flushed are dropped
+    void destroy();
+
+    // Queue a copy of 'size' bytes into 'dst' at 'dstOffset'. Data larger than
+    // the ring is split into several copies
+    void upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+    // Submit the queued copies; does nothing if none are queued
+    void flush();
+
+    bool hasPendingUploads() const;
+
+    // Statistics
+    VkDeviceSize getRingSize() const { return m_ringSize; }
+    VkDeviceSize getRingUsed() const { return m_head - m_tail; }
+    uint64_t getSubmitCount() const { return m_submitCount; }
+
+private:
+    struct PendingCopy {
+        VkBuffer dst;
+        VkBufferCopy region;
+    };
+
+    struct Batch {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        // Ring position up to which the batch's staging data reaches
+        uint64_t ringEnd = 0;
+    };
+
+    // m_mutex must be held by the following
+    void flushLocked();
+    // Reserve 'size' bytes of the ring; returns the ring offset
+    VkDeviceSize reserve(VkDeviceSize size);
+    // Release the ring space of batches whose fence has signalled
+    void retireBatches(bool waitForOldest);
+    Batch acquireBatch();
+
+    VkDevice m_device;
+    VkQueue m_queue;
+    GpuAllocator* m_allocator;
+    VkCommandPool m_commandPool;
+
+    VkBuffer m_ringBuffer;
+    GpuAllocation m_ringMemory;
+    uint8_t* m_ringMapped;
+    VkDeviceSize m_ringSize;
+    // Monotonic byte positions; ring offset = position % m_ringSize
+    uint64_t m_head;
+    uint64_t m_tail;
+
+    std::vector<PendingCopy> m_pending;
+    std::deque<Batch> m_inFlight;
+    std::vector<Batch> m_freeBatches;
+    uint64_t m_submitCount;
+    mutable std::mutex m_mutex;
+};
@@ -6,6 +6,27 @@
 #include <cstring>
 #include <optional>
 #include <set>
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+
+namespace {
+
+// 管线缓存文件头，后接驱动返回的缓存数据。
+// 设备或驱动版本不一致时丢弃旧数据
+struct PipelineCacheFileHeader {
+    char magic[8];              // "FLPIPEC\0"
+    uint32_t headerSize;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+    uint64_t dataSize;
+};
+
+const char PIPELINE_CACHE_MAGIC[8] = { 'F', 'L', 'P', 'I', 'P', 'E', 'C', '\0' };
+
+} // namespace
 
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
@@ -30,10 +51,15 @@ QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surfa
             indices.graphicsFamily = i;
         }
 
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
-        if (presentSupport) {
-            indices.presentFamily = i;
+        // 无窗口模式下没有surface，不需要呈现队列
+        if (surface == VK_NULL_HANDLE) {
+            indices.presentFamily = indices.graphicsFamily;
+        } else {
+            VkBool32 presentSupport = false;
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+            if (presentSupport) {
+                indices.presentFamily = i;
+            }
         }
 
         if (indices.isComplete()) {
@@ -46,21 +72,38 @@ QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surfa
 
 VulkanContext::VulkanContext(int width, int height, const char* title)
     : m_width(width), m_height(height), m_title(title),
-      m_window(nullptr), m_instance(VK_NULL_HANDLE),
+      m_window(nullptr), m_headless(false), m_hasProperties2(false), m_hasMemoryBudget(false),
+      m_instance(VK_NULL_HANDLE),
       m_physicalDevice(VK_NULL_HANDLE), m_device(VK_NULL_HANDLE),
       m_graphicsQueue(VK_NULL_HANDLE), m_presentQueue(VK_NULL_HANDLE),
+      m_graphicsQueueFamily(0), m_enabledFeatures{},
       m_surface(VK_NULL_HANDLE), m_swapchain(VK_NULL_HANDLE),
       m_swapchainImageFormat(VK_FORMAT_UNDEFINED),
-      m_swapchainExtent({0, 0}),
+      m_swapchainExtent({0, 0}), m_presentMode(VK_PRESENT_MODE_FIFO_KHR),
+      m_depthFormat(VK_FORMAT_UNDEFINED), m_depthImage(VK_NULL_HANDLE),
+      m_depthImageView(VK_NULL_HANDLE),
       m_renderPass(VK_NULL_HANDLE), m_pipelineLayout(VK_NULL_HANDLE),
-      m_graphicsPipeline(VK_NULL_HANDLE), m_commandPool(VK_NULL_HANDLE),
-      m_currentFrame(0), m_framebufferResized(false) {}
+      m_graphicsPipeline(VK_NULL_HANDLE), m_commandPool(VK_NULL_HANDLE), m_pipelineCache(VK_NULL_HANDLE),
+      m_frameCount(DEFAULT_FRAMES_IN_FLIGHT), m_currentFrame(0), m_frameNumber(0), m_framebufferResized(false) {}
 
 VulkanContext::~VulkanContext() {
     cleanup();
 }
 
 bool VulkanContext::init() {
+    Config& config = Config::getInstance();
+    m_headless = m_headless || config.getBool("headless", false);
+
+    // 飞行中的帧数：越多吞吐量越高，越少输入延迟越低
+    int frameCount = config.getInt("frames_in_flight", DEFAULT_FRAMES_IN_FLIGHT);
+    m_frameCount = static_cast<uint32_t>((std::max)(1, (std::min)(frameCount, static_cast<int>(MAX_FRAMES_IN_FLIGHT))));
+    if (static_cast<int>(m_frameCount) != frameCount) {
+        Logger::warn("frames_in_flight {} is out of range, using {}", frameCount, m_frameCount);
+    }
+    if (m_headless) {
+        Logger::info("Running headless, rendering to offscreen images ({}x{})", m_width, m_height);
+    }
+
     if (!initWindow()) {
         return false;
     }
@@ -74,6 +117,10 @@ bool VulkanContext::init() {
 }
 
 bool VulkanContext::initWindow() {
+    if (m_headless) {
+        return true;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -96,13 +143,39 @@ bool VulkanContext::initVulkan() {
         pickPhysicalDevice();
         createLogicalDevice();
         Logger::debug("Completed createLogicalDevice!");
+
+        // 所有设备内存从共享分配器的大块中子分配
+        m_allocator.init(m_device, m_physicalDevice,
+                         static_cast<VkDeviceSize>((std::max)(config.getInt("gpu_memory_block_mb", 64), 1)) * 1024 * 1024);
+        if (m_hasMemoryBudget) {
+            m_allocator.enableMemoryBudget(m_instance);
+        }
+        // gpu_memory_budget_mb 为0时使用驱动报告（或估算）的预算
+        m_allocator.setBudgetLimit(
+            static_cast<VkDeviceSize>((std::max)(config.getInt("gpu_memory_budget_mb", 0), 0)) * 1024 * 1024);
+        GpuMemoryBudget budget = m_allocator.getBudget();
+        Logger::info("GPU memory budget: {} MB ({}), {} MB in use", budget.budget / (1024 * 1024),
+                     budget.fromExtension ? "VK_EXT_memory_budget" : "estimated", budget.usage / (1024 * 1024));
+
+        m_pipelineCacheFile = config.getString("pipeline_cache_file", "pipeline_cache.bin");
+        createPipelineCache();
+        m_pipelineBuilder.init(m_device, m_pipelineCache);
+        Logger::debug("Completed createPipelineCache!");
         
-        createSwapchain();
-        Logger::debug("Completed createSwapchain!");
+        if (m_headless) {
+            createOffscreenImages();
+            Logger::debug("Completed createOffscreenImages!");
+        } else {
+            createSwapchain();
+            Logger::debug("Completed createSwapchain!");
+        }
         
         createImageViews();
         Logger::debug("Completed createImageViews!");
         
+        createDepthResources();
+        Logger::debug("Completed createDepthResources!");
+        
         createRenderPass();
         Logger::debug("Completed createRenderPass!");
         
@@ -115,11 +188,12 @@ bool VulkanContext::initVulkan() {
         createCommandPool();
         Logger::debug("Completed createCommandPool!");
         
-        createCommandBuffers();
-        Logger::debug("Completed createCommandBuffers!");
-        
-        createSyncObjects();
-        Logger::debug("Completed createSyncObjects!");
+        createFrames();
+        Logger::debug("Completed createFrames!");
+
+        // 上传经由共享的暂存环形缓冲区批量提交
+        m_uploadBatcher.create(m_device, m_graphicsQueue, m_graphicsQueueFamily, m_allocator,
+                               static_cast<VkDeviceSize>((std::max)(config.getInt("staging_ring_mb", 16), 1)) * 1024 * 1024);
         
         return true;
     } catch (const std::exception& e) {
@@ -138,15 +212,31 @@ void VulkanContext::createInstance() {
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.apiVersion = VK_API_VERSION_1_0;
 
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    // 无窗口模式不需要surface扩展
+    std::vector<const char*> extensions;
+    if (!m_headless) {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
+
+    // 查询显存预算（VK_EXT_memory_budget）需要该实例扩展
+    uint32_t availableCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, nullptr);
+    std::vector<VkExtensionProperties> available(availableCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, available.data());
+    m_hasProperties2 = std::any_of(available.begin(), available.end(), [](const VkExtensionProperties& e) {
+        return strcmp(e.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0;
+    });
+    if (m_hasProperties2) {
+        extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    }
 
     VkInstanceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
-    createInfo.enabledExtensionCount = glfwExtensionCount;
-    createInfo.ppEnabledExtensionNames = glfwExtensions;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
     createInfo.enabledLayerCount = 0;
 
     if (vkCreateInstance(&createInfo, nullptr, &m_instance) != VK_SUCCESS) {
@@ -155,6 +245,9 @@ void VulkanContext::createInstance() {
 }
 
 void VulkanContext::createSurface() {
+    if (m_headless) {
+        return;
+    }
     if (glfwCreateWindowSurface(m_instance, m_window, nullptr, &m_surface) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create window surface!");
     }
@@ -210,6 +303,7 @@ void VulkanContext::createLogicalDevice() {
     uint32_t graphicsFamily = indices.graphicsFamily.value();
     uint32_t presentFamily = indices.presentFamily.value();
     
+    m_graphicsQueueFamily = graphicsFamily;
     Logger::debug("Graphics family index: {}", graphicsFamily);
     Logger::debug("Present family index: {}", presentFamily);
     
@@ -235,11 +329,21 @@ void VulkanContext::createLogicalDevice() {
     
     Logger::debug("Created queue create infos, size: {}", queueCreateInfos.size());
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures{};
     // Enable large points for point cloud rendering
-    deviceFeatures.largePoints = VK_TRUE;
+    deviceFeatures.largePoints = supportedFeatures.largePoints;
     // Enable wide lines for coordinate system rendering
-    deviceFeatures.wideLines = VK_TRUE;
+    deviceFeatures.wideLines = supportedFeatures.wideLines;
+    // Enable multi-draw indirect for GPU-driven point cloud rendering when available
+    deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    // Enable firstInstance in indirect draws for instanced point sprites
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    // Enable line polygon mode for the wireframe display option
+    deviceFeatures.fillModeNonSolid = supportedFeatures.fillModeNonSolid;
+    m_enabledFeatures = deviceFeatures;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -247,9 +351,25 @@ void VulkanContext::createLogicalDevice() {
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    const std::vector<const char*> deviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
+    std::vector<const char*> deviceExtensions;
+    if (!m_headless) {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+
+    // 可用时启用显存预算扩展，否则按堆大小估算预算
+    m_hasMemoryBudget = false;
+    if (m_hasProperties2) {
+        uint32_t availableCount = 0;
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &availableCount, nullptr);
+        std::vector<VkExtensionProperties> available(availableCount);
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &availableCount, available.data());
+        m_hasMemoryBudget = std::any_of(available.begin(), available.end(), [](const VkExtensionProperties& e) {
+            return strcmp(e.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+        });
+    }
+    if (m_hasMemoryBudget) {
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
 
     createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
     createInfo.ppEnabledExtensionNames = deviceExtensions.data();
@@ -272,29 +392,57 @@ void VulkanContext::createLogicalDevice() {
 }
 
 void VulkanContext::createSwapchain() {
-    // 简化的交换链创建，实际项目中应该更完整
+    VkSurfaceCapabilitiesKHR capabilities;
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physicalDevice, m_surface, &capabilities);
+
+    // 窗口大小由surface决定；currentExtent为特殊值时使用帧缓冲区大小
+    VkExtent2D extent = capabilities.currentExtent;
+    if (extent.width == UINT32_MAX) {
+        int width = m_width;
+        int height = m_height;
+        if (m_window) {
+            glfwGetFramebufferSize(m_window, &width, &height);
+        }
+        extent.width = (std::max)(capabilities.minImageExtent.width,
+                                  (std::min)(capabilities.maxImageExtent.width, static_cast<uint32_t>(width)));
+        extent.height = (std::max)(capabilities.minImageExtent.height,
+                                   (std::min)(capabilities.maxImageExtent.height, static_cast<uint32_t>(height)));
+    }
+
+    m_presentMode = choosePresentMode();
+
+    // MAILBOX需要第三张图像，否则CPU仍会等待呈现引擎释放图像
+    uint32_t minImageCount = (std::max)(m_presentMode == VK_PRESENT_MODE_MAILBOX_KHR ? 3u : 2u,
+                                        capabilities.minImageCount);
+    if (capabilities.maxImageCount > 0) {
+        minImageCount = (std::min)(minImageCount, capabilities.maxImageCount);
+    }
+
     VkSwapchainCreateInfoKHR createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
     createInfo.surface = m_surface;
 
-    createInfo.minImageCount = 2;
+    createInfo.minImageCount = minImageCount;
     createInfo.imageFormat = VK_FORMAT_B8G8R8A8_SRGB;
     createInfo.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
-    createInfo.imageExtent = { static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height) };
+    createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     createInfo.queueFamilyIndexCount = 0;
     createInfo.pQueueFamilyIndices = nullptr;
-    createInfo.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    createInfo.preTransform = capabilities.currentTransform;
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    createInfo.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    createInfo.presentMode = m_presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    // 重建时传入旧交换链，呈现引擎可以继续显示旧图像直到新图像就绪
+    createInfo.oldSwapchain = m_swapchain;
 
-    if (vkCreateSwapchainKHR(m_device, &createInfo, nullptr, &m_swapchain) != VK_SUCCESS) {
+    VkSwapchainKHR swapchain;
+    if (vkCreateSwapchainKHR(m_device, &createInfo, nullptr, &swapchain) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create swap chain!");
     }
+    m_swapchain = swapchain;
 
     uint32_t imageCount;
     vkGetSwapchainImagesKHR(m_device, m_swapchain, &imageCount, nullptr);
@@ -302,7 +450,168 @@ void VulkanContext::createSwapchain() {
     vkGetSwapchainImagesKHR(m_device, m_swapchain, &imageCount, m_swapchainImages.data());
 
     m_swapchainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+    m_swapchainExtent = extent;
+    m_width = static_cast<int>(extent.width);
+    m_height = static_cast<int>(extent.height);
+}
+
+VkPresentModeKHR VulkanContext::choosePresentMode() {
+    // present_mode: fifo（垂直同步）、mailbox（低延迟不撕裂）、immediate（最低延迟，可能撕裂）
+    std::string name = Config::getInstance().getString("present_mode", "mailbox");
+    VkPresentModeKHR requested = VK_PRESENT_MODE_FIFO_KHR;
+    if (name == "mailbox") {
+        requested = VK_PRESENT_MODE_MAILBOX_KHR;
+    } else if (name == "immediate") {
+        requested = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    } else if (name != "fifo") {
+        Logger::warn("Unknown present_mode '{}', using fifo", name);
+    }
+
+    uint32_t modeCount = 0;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &modeCount, nullptr);
+    std::vector<VkPresentModeKHR> modes(modeCount);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &modeCount, modes.data());
+
+    // FIFO总是被支持
+    if (requested != VK_PRESENT_MODE_FIFO_KHR &&
+        std::find(modes.begin(), modes.end(), requested) == modes.end()) {
+        Logger::warn("Present mode '{}' is not supported by the surface, using fifo", name);
+        requested = VK_PRESENT_MODE_FIFO_KHR;
+    }
+    if (requested != m_presentMode || m_swapchain == VK_NULL_HANDLE) {
+        Logger::info("Present mode: {}", requested == VK_PRESENT_MODE_MAILBOX_KHR ? "mailbox" :
+                     requested == VK_PRESENT_MODE_IMMEDIATE_KHR ? "immediate" : "fifo");
+    }
+    return requested;
+}
+
+bool VulkanContext::recreateSwapchain() {
+    if (m_headless) {
+        m_framebufferResized = false;
+        return true;
+    }
+
+    // 最小化时帧缓冲区大小为0，无法创建交换链
+    int width = 0;
+    int height = 0;
+    glfwGetFramebufferSize(m_window, &width, &height);
+    if (width == 0 || height == 0) {
+        return false;
+    }
+    m_framebufferResized = false;
+
+    // 旧交换链及其帧缓冲区可能仍被飞行中的帧使用，延迟销毁
+    VkSwapchainKHR oldSwapchain = m_swapchain;
+    std::vector<VkImageView> oldImageViews = std::move(m_swapchainImageViews);
+    std::vector<VkFramebuffer> oldFramebuffers = std::move(m_swapchainFramebuffers);
+    m_swapchainImageViews.clear();
+    m_swapchainFramebuffers.clear();
+    retireDepthResources();
+
+    try {
+        createSwapchain();
+        createImageViews();
+        createDepthResources();
+        createFramebuffers();
+    } catch (const std::exception& e) {
+        // 旧交换链即使创建失败也已被废弃，下一帧重试
+        retireSwapchain(oldSwapchain, std::move(oldImageViews), std::move(oldFramebuffers));
+        if (m_swapchain != oldSwapchain) {
+            retireSwapchain(m_swapchain, std::move(m_swapchainImageViews), std::move(m_swapchainFramebuffers));
+        }
+        m_swapchain = VK_NULL_HANDLE;
+        m_swapchainImageViews.clear();
+        m_swapchainFramebuffers.clear();
+        m_framebufferResized = true;
+        Logger::error("Swapchain recreation failed: {}", e.what());
+        return false;
+    }
+    retireSwapchain(oldSwapchain, std::move(oldImageViews), std::move(oldFramebuffers));
+
+    Logger::debug("Swapchain recreated: {}x{}, {} images",
+                  m_swapchainExtent.width, m_swapchainExtent.height, m_swapchainImages.size());
+    return true;
+}
+
+void VulkanContext::retireSwapchain(VkSwapchainKHR swapchain, std::vector<VkImageView> imageViews,
+                                    std::vector<VkFramebuffer> framebuffers) {
+    VkDevice device = m_device;
+    deferDelete([device, swapchain, imageViews, framebuffers]() {
+        for (auto framebuffer : framebuffers) {
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        }
+        for (auto imageView : imageViews) {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        if (swapchain != VK_NULL_HANDLE) {
+            vkDestroySwapchainKHR(device, swapchain, nullptr);
+        }
+    });
+}
+
+void VulkanContext::retireDepthResources() {
+    // 深度缓冲区与旧交换链一起延迟销毁
+    VkDevice device = m_device;
+    GpuAllocator* allocator = &m_allocator;
+    VkImage image = m_depthImage;
+    GpuAllocation memory = m_depthImageMemory;
+    VkImageView imageView = m_depthImageView;
+    deferDelete([device, allocator, image, memory, imageView]() mutable {
+        if (imageView != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        if (image != VK_NULL_HANDLE) {
+            vkDestroyImage(device, image, nullptr);
+        }
+        allocator->free(memory);
+    });
+    m_depthImage = VK_NULL_HANDLE;
+    m_depthImageMemory = GpuAllocation();
+    m_depthImageView = VK_NULL_HANDLE;
+}
+
+void VulkanContext::waitForFrame() {
+    FrameContext& frame = m_frames[m_currentFrame];
+    VkFence fence = frame.getInFlightFence();
+    vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+    frame.reset();
+}
+
+void VulkanContext::waitForFramesInFlight() {
+    std::vector<VkFence> fences;
+    for (auto& frame : m_frames) {
+        fences.push_back(frame.getInFlightFence());
+    }
+    vkWaitForFences(m_device, static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
+}
+
+void VulkanContext::createOffscreenImages() {
+    // 每个飞行中的帧使用一张离屏图像，代替交换链图像
+    m_swapchainImageFormat = VK_FORMAT_R8G8B8A8_SRGB;
     m_swapchainExtent = { static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height) };
+    m_swapchainImages.resize(m_frameCount, VK_NULL_HANDLE);
+    m_offscreenImageMemory.resize(m_frameCount);
+
+    for (size_t i = 0; i < m_swapchainImages.size(); i++) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = m_swapchainImageFormat;
+        imageInfo.extent = { m_swapchainExtent.width, m_swapchainExtent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(m_device, &imageInfo, nullptr, &m_swapchainImages[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create offscreen image!");
+        }
+
+        m_offscreenImageMemory[i] = m_allocator.allocateImage(m_swapchainImages[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
 }
 
 void VulkanContext::createImageViews() {
@@ -330,6 +639,67 @@ void VulkanContext::createImageViews() {
     }
 }
 
+VkFormat VulkanContext::findDepthFormat() {
+    // 优先使用无模板的32位浮点深度，所有实现至少支持其中一种
+    const VkFormat candidates[] = {
+        VK_FORMAT_D32_SFLOAT,
+        VK_FORMAT_D32_SFLOAT_S8_UINT,
+        VK_FORMAT_D24_UNORM_S8_UINT,
+        VK_FORMAT_X8_D24_UNORM_PACK32,
+        VK_FORMAT_D16_UNORM
+    };
+    for (VkFormat format : candidates) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &properties);
+        if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+            return format;
+        }
+    }
+    throw std::runtime_error("Failed to find a supported depth format!");
+}
+
+void VulkanContext::createDepthResources() {
+    if (m_depthFormat == VK_FORMAT_UNDEFINED) {
+        m_depthFormat = findDepthFormat();
+        Logger::debug("Depth format: {}", static_cast<int>(m_depthFormat));
+    }
+
+    // 所有帧共用一个深度缓冲区：渲染通道的子通道依赖保证了帧之间深度写入的顺序
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = m_depthFormat;
+    imageInfo.extent = { m_swapchainExtent.width, m_swapchainExtent.height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(m_device, &imageInfo, nullptr, &m_depthImage) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create depth image!");
+    }
+
+    m_depthImageMemory = m_allocator.allocateImage(m_depthImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = m_depthImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = m_depthFormat;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(m_device, &viewInfo, nullptr, &m_depthImageView) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create depth image view!");
+    }
+}
+
 void VulkanContext::createRenderPass() {
     VkAttachmentDescription colorAttachment{};
     colorAttachment.format = m_swapchainImageFormat;
@@ -339,23 +709,54 @@ void VulkanContext::createRenderPass() {
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // 离屏图像渲染后用于回读
+    colorAttachment.finalLayout = m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    // 深度只在渲染通道内使用，不需要保存
+    VkAttachmentDescription depthAttachment{};
+    depthAttachment.format = m_depthFormat;
+    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentReference depthAttachmentRef{};
+    depthAttachmentRef.attachment = 1;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+    // 上一帧对共享深度缓冲区的写入必须在本帧清除之前完成；
+    // 颜色附件等待获取图像的信号量（COLOR_ATTACHMENT_OUTPUT阶段）
+    VkSubpassDependency dependency{};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    VkAttachmentDescription attachments[] = { colorAttachment, depthAttachment };
 
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = 1;
-    renderPassInfo.pAttachments = &colorAttachment;
+    renderPassInfo.attachmentCount = 2;
+    renderPassInfo.pAttachments = attachments;
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 1;
+    renderPassInfo.pDependencies = &dependency;
 
     if (vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create render pass!");
@@ -385,13 +786,14 @@ void VulkanContext::createFramebuffers() {
 
     for (size_t i = 0; i < m_swapchainImageViews.size(); i++) {
         VkImageView attachments[] = {
-            m_swapchainImageViews[i]
+            m_swapchainImageViews[i],
+            m_depthImageView
         };
 
         VkFramebufferCreateInfo framebufferInfo{};
         framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
         framebufferInfo.renderPass = m_renderPass;
-        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.attachmentCount = 2;
         framebufferInfo.pAttachments = attachments;
         framebufferInfo.width = m_swapchainExtent.width;
         framebufferInfo.height = m_swapchainExtent.height;
@@ -416,51 +818,213 @@ void VulkanContext::createCommandPool() {
     }
 }
 
-void VulkanContext::createCommandBuffers() {
-    m_commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+void VulkanContext::createFrames() {
+    // 每帧的命令缓冲区、同步对象和临时上传区
+    VkDeviceSize uploadArenaSize = static_cast<VkDeviceSize>(
+        (std::max)(Config::getInstance().getInt("frame_upload_arena_kb", 1024), 0)) * 1024;
 
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = m_commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = static_cast<uint32_t>(m_commandBuffers.size());
+    m_frames.resize(m_frameCount);
+    for (auto& frame : m_frames) {
+        frame.create(m_device, m_allocator, m_commandPool, uploadArenaSize);
+    }
+    m_currentFrame = 0;
+    Logger::debug("Frames in flight: {}", m_frameCount);
+}
+
+bool VulkanContext::shouldClose() const {
+    if (m_headless) {
+        return false;
+    }
+    return glfwWindowShouldClose(m_window);
+}
 
-    if (vkAllocateCommandBuffers(m_device, &allocInfo, m_commandBuffers.data()) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate command buffers!");
+void VulkanContext::pollEvents() {
+    if (m_headless) {
+        return;
     }
+    glfwPollEvents();
 }
 
-void VulkanContext::createSyncObjects() {
-    m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    m_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    m_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+bool VulkanContext::readbackImage(uint32_t imageIndex, std::vector<uint8_t>& pixels) {
+    // 交换链图像没有TRANSFER_SRC用途，只支持离屏图像回读
+    if (!m_headless) {
+        Logger::error("Image readback is only supported in headless mode!");
+        return false;
+    }
+    if (imageIndex >= m_swapchainImages.size()) {
+        return false;
+    }
+
+    VkDeviceSize size = static_cast<VkDeviceSize>(m_swapchainExtent.width) * m_swapchainExtent.height * 4;
 
-    VkSemaphoreCreateInfo semaphoreInfo{};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    // 主机可见的暂存缓冲区
+    VkBuffer buffer = VK_NULL_HANDLE;
+    GpuAllocation memory;
+    try {
+        m_allocator.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 buffer, memory, GpuMemoryCategory::Staging);
+    } catch (const std::exception& e) {
+        Logger::error("Failed to create readback buffer: {}", e.what());
+        return false;
+    }
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    vkDeviceWaitIdle(m_device);
+
+    VkCommandBufferAllocateInfo cmdAllocInfo{};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.commandPool = m_commandPool;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdAllocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    vkAllocateCommandBuffers(m_device, &cmdAllocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // 渲染通道结束时图像已转换为TRANSFER_SRC布局，这里只需要内存依赖
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_swapchainImages[imageIndex];
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = { m_swapchainExtent.width, m_swapchainExtent.height, 1 };
+    vkCmdCopyImageToBuffer(commandBuffer, m_swapchainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           buffer, 1, &region);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(m_graphicsQueue);
+    vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
+
+    pixels.resize(static_cast<size_t>(size));
+    memcpy(pixels.data(), memory.mapped, static_cast<size_t>(size));
+
+    m_allocator.destroyBuffer(buffer, memory);
+    return true;
+}
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        if (vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(m_device, &fenceInfo, nullptr, &m_inFlightFences[i]) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create sync objects!");
+void VulkanContext::createPipelineCache() {
+    VkPhysicalDeviceProperties deviceProps;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProps);
+
+    // 读取上次保存的缓存；文件缺失或与当前设备、驱动不匹配时从空缓存开始
+    std::vector<char> initialData;
+    std::ifstream file(m_pipelineCacheFile, std::ios::binary);
+    if (!m_pipelineCacheFile.empty() && file.is_open()) {
+        PipelineCacheFileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || std::memcmp(header.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC)) != 0 ||
+            header.headerSize != sizeof(PipelineCacheFileHeader)) {
+            Logger::warn("Ignoring invalid pipeline cache file: {}", m_pipelineCacheFile);
+        } else if (header.vendorID != deviceProps.vendorID || header.deviceID != deviceProps.deviceID ||
+                   header.driverVersion != deviceProps.driverVersion ||
+                   std::memcmp(header.pipelineCacheUUID, deviceProps.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+            Logger::info("Pipeline cache was written by another device or driver, starting empty");
+        } else {
+            initialData.resize(static_cast<size_t>(header.dataSize));
+            file.read(initialData.data(), static_cast<std::streamsize>(initialData.size()));
+            if (!file) {
+                Logger::warn("Truncated pipeline cache file: {}", m_pipelineCacheFile);
+                initialData.clear();
+            }
         }
     }
-}
 
-bool VulkanContext::shouldClose() const {
-    return glfwWindowShouldClose(m_window);
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+    if (vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS) {
+        // 驱动仍可能拒绝通过校验的数据，此时退回空缓存
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        if (vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline cache!");
+        }
+        initialData.clear();
+    }
+    Logger::info("Pipeline cache: {} KB loaded from {}", initialData.size() / 1024, m_pipelineCacheFile);
 }
 
-void VulkanContext::pollEvents() {
-    glfwPollEvents();
+void VulkanContext::savePipelineCache() {
+    if (m_pipelineCacheFile.empty()) {
+        return;
+    }
+
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+        return;
+    }
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+        Logger::warn("Failed to read pipeline cache data");
+        return;
+    }
+
+    VkPhysicalDeviceProperties deviceProps;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProps);
+    PipelineCacheFileHeader header{};
+    std::memcpy(header.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC));
+    header.headerSize = sizeof(PipelineCacheFileHeader);
+    header.vendorID = deviceProps.vendorID;
+    header.deviceID = deviceProps.deviceID;
+    header.driverVersion = deviceProps.driverVersion;
+    std::memcpy(header.pipelineCacheUUID, deviceProps.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = dataSize;
+
+    // 先写临时文件再替换，避免中途退出留下损坏的缓存
+    std::string tempFile = m_pipelineCacheFile + ".tmp";
+    {
+        std::ofstream file(tempFile, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            Logger::warn("Failed to open pipeline cache for writing: {}", tempFile);
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), static_cast<std::streamsize>(dataSize));
+        file.close();
+        if (!file) {
+            Logger::warn("Failed to write pipeline cache: {}", tempFile);
+            std::remove(tempFile.c_str());
+            return;
+        }
+    }
+    std::remove(m_pipelineCacheFile.c_str());
+    if (std::rename(tempFile.c_str(), m_pipelineCacheFile.c_str()) != 0) {
+        Logger::warn("Failed to replace pipeline cache: {}", m_pipelineCacheFile);
+        std::remove(tempFile.c_str());
+        return;
+    }
+    Logger::info("Pipeline cache saved: {} ({} KB)", m_pipelineCacheFile, dataSize / 1024);
 }
 
 void VulkanContext::cleanup() {
-    // 清理Vulkan资源
+    // 清理Vulkan资源，先执行各帧延迟删除的对象
+    for (auto& frame : m_frames) {
+        frame.destroy(m_commandPool);
+    }
+    m_frames.clear();
+    m_uploadBatcher.destroy();
+
     for (size_t i = 0; i < m_swapchainFramebuffers.size(); i++) {
         vkDestroyFramebuffer(m_device, m_swapchainFramebuffers[i], nullptr);
     }
@@ -472,21 +1036,45 @@ void VulkanContext::cleanup() {
     vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
     vkDestroyRenderPass(m_device, m_renderPass, nullptr);
 
+    // 所有管线都已销毁，保存缓存供下次启动使用
+    m_pipelineBuilder.cleanup();
+    if (m_pipelineCache != VK_NULL_HANDLE) {
+        savePipelineCache();
+        vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+        m_pipelineCache = VK_NULL_HANDLE;
+    }
+
     for (auto imageView : m_swapchainImageViews) {
         vkDestroyImageView(m_device, imageView, nullptr);
     }
 
-    vkDestroySwapchainKHR(m_device, m_swapchain, nullptr);
+    if (m_depthImageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(m_device, m_depthImageView, nullptr);
+        m_depthImageView = VK_NULL_HANDLE;
+    }
+    if (m_depthImage != VK_NULL_HANDLE) {
+        vkDestroyImage(m_device, m_depthImage, nullptr);
+        m_depthImage = VK_NULL_HANDLE;
+    }
+    m_allocator.free(m_depthImageMemory);
+
+    if (m_swapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(m_device, m_swapchain, nullptr);
+    } else {
+        // 离屏图像由我们自己创建
+        for (size_t i = 0; i < m_offscreenImageMemory.size(); i++) {
+            vkDestroyImage(m_device, m_swapchainImages[i], nullptr);
+            m_allocator.free(m_offscreenImageMemory[i]);
+        }
+    }
     vkDestroyCommandPool(m_device, m_commandPool, nullptr);
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vkDestroySemaphore(m_device, m_renderFinishedSemaphores[i], nullptr);
-        vkDestroySemaphore(m_device, m_imageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(m_device, m_inFlightFences[i], nullptr);
-    }
+    m_allocator.cleanup();
 
     vkDestroyDevice(m_device, nullptr);
-    vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+    if (m_surface != VK_NULL_HANDLE) {
+        vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+    }
     vkDestroyInstance(m_instance, nullptr);
 
     // 清理窗口
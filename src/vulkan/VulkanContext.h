@@ -4,9 +4,17 @@
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <string>
+#include "FrameContext.h"
+#include "GpuAllocator.h"
+#include "UploadBatcher.h"
+#include "PipelineBuilder.h"
 
 class VulkanContext {
 public:
+    // Upper bound of the configurable frames in flight (config key frames_in_flight)
+    static const uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+    static const uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+
     VulkanContext(int width, int height, const char* title);
     ~VulkanContext();
 
@@ -15,6 +23,43 @@ public:
     bool shouldClose() const;
     void pollEvents();
 
+    // Headless mode renders into offscreen images instead of a window swapchain
+    bool isHeadless() const { return m_headless; }
+    // Force headless mode regardless of config.ini; must be called before init()
+    void setHeadless(bool headless) { m_headless = headless; }
+    // Copy a rendered offscreen image into tightly packed RGBA8 pixels (headless
+    // mode only). Waits for the device to be idle.
+    bool readbackImage(uint32_t imageIndex, std::vector<uint8_t>& pixels);
+
+    // Window resize handling: the flag is set from the GLFW callbacks, the
+    // renderer then calls recreateSwapchain() at the start of the next frame.
+    // Returns false while the window is minimized (zero-sized framebuffer).
+    void setFramebufferResized() { m_framebufferResized = true; }
+    bool isFramebufferResized() const { return m_framebufferResized; }
+    bool recreateSwapchain();
+
+    // Frames-in-flight ring. waitForFrame() blocks until the current slot is
+    // free again, then recycles its upload arena and runs its deferred deletes.
+    void waitForFrame();
+    // Block until every submitted frame has completed. A frame that returns
+    // before submitting calls this, since its slot's fence will not signal
+    // after the deletes it deferred
+    void waitForFramesInFlight();
+    FrameContext& getCurrentFrameContext() { return m_frames[m_currentFrame]; }
+    // Destroy an object once every frame that may still use it has completed
+    void deferDelete(std::function<void()> deleter) { m_frames[m_currentFrame].deferDelete(std::move(deleter)); }
+
+    // Shared device memory sub-allocator (config gpu_memory_block_mb)
+    GpuAllocator& getAllocator() { return m_allocator; }
+    // Staging ring for buffer uploads (config staging_ring_mb); the renderer
+    // flushes it once per frame before submitting the frame
+    UploadBatcher& getUploadBatcher() { return m_uploadBatcher; }
+    // Pipeline cache shared by every pipeline; loaded from and saved to the
+    // file named by config pipeline_cache_file
+    VkPipelineCache getPipelineCache() const { return m_pipelineCache; }
+    // Deduplicating graphics pipeline builder on top of the pipeline cache
+    PipelineBuilder& getPipelineBuilder() { return m_pipelineBuilder; }
+
     // Getters
     GLFWwindow* getWindow() const { return m_window; }
     VkInstance getInstance() const { return m_instance; }
@@ -22,22 +67,25 @@ public:
     VkDevice getDevice() const { return m_device; }
     VkQueue getGraphicsQueue() const { return m_graphicsQueue; }
     VkQueue getPresentQueue() const { return m_presentQueue; }
+    uint32_t getGraphicsQueueFamily() const { return m_graphicsQueueFamily; }
+    const VkPhysicalDeviceFeatures& getEnabledFeatures() const { return m_enabledFeatures; }
     VkSurfaceKHR getSurface() const { return m_surface; }
     VkSwapchainKHR getSwapchain() const { return m_swapchain; }
     const std::vector<VkImage>& getSwapchainImages() const { return m_swapchainImages; }
     VkFormat getSwapchainImageFormat() const { return m_swapchainImageFormat; }
     VkExtent2D getSwapchainExtent() const { return m_swapchainExtent; }
+    VkPresentModeKHR getPresentMode() const { return m_presentMode; }
     const std::vector<VkImageView>& getSwapchainImageViews() const { return m_swapchainImageViews; }
+    VkFormat getDepthFormat() const { return m_depthFormat; }
     VkRenderPass getRenderPass() const { return m_renderPass; }
     const std::vector<VkFramebuffer>& getSwapchainFramebuffers() const { return m_swapchainFramebuffers; }
     VkPipelineLayout getPipelineLayout() const { return m_pipelineLayout; }
     VkPipeline getGraphicsPipeline() const { return m_graphicsPipeline; }
-    const std::vector<VkCommandBuffer>& getCommandBuffers() const { return m_commandBuffers; }
-    const std::vector<VkSemaphore>& getImageAvailableSemaphores() const { return m_imageAvailableSemaphores; }
-    const std::vector<VkSemaphore>& getRenderFinishedSemaphores() const { return m_renderFinishedSemaphores; }
-    const std::vector<VkFence>& getInFlightFences() const { return m_inFlightFences; }
+    VkCommandPool getCommandPool() const { return m_commandPool; }
+    uint32_t getFrameCount() const { return static_cast<uint32_t>(m_frames.size()); }
     size_t getCurrentFrame() const { return m_currentFrame; }
-    void nextFrame() { m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT; }
+    uint64_t getFrameNumber() const { return m_frameNumber; }
+    void nextFrame() { m_currentFrame = (m_currentFrame + 1) % m_frames.size(); m_frameNumber++; }
 
 private:
     bool initWindow();
@@ -47,43 +95,65 @@ private:
     void pickPhysicalDevice();
     void createLogicalDevice();
     void createSwapchain();
+    VkPresentModeKHR choosePresentMode();
+    void createOffscreenImages();
     void createImageViews();
+    VkFormat findDepthFormat();
+    void createDepthResources();
+    void retireDepthResources();
     void createRenderPass();
     void createGraphicsPipeline();
     void createFramebuffers();
     void createCommandPool();
-    void createCommandBuffers();
-    void createSyncObjects();
-
-    static const uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+    void createFrames();
+    void createPipelineCache();
+    void savePipelineCache();
+    void retireSwapchain(VkSwapchainKHR swapchain, std::vector<VkImageView> imageViews,
+                         std::vector<VkFramebuffer> framebuffers);
 
     // Window
     int m_width;
     int m_height;
     const char* m_title;
     GLFWwindow* m_window;
+    bool m_headless;
+    // VK_KHR_get_physical_device_properties2 / VK_EXT_memory_budget enabled
+    bool m_hasProperties2;
+    bool m_hasMemoryBudget;
 
     // Vulkan
     VkInstance m_instance;
     VkPhysicalDevice m_physicalDevice;
     VkDevice m_device;
+    GpuAllocator m_allocator;
     VkQueue m_graphicsQueue;
     VkQueue m_presentQueue;
+    uint32_t m_graphicsQueueFamily;
+    VkPhysicalDeviceFeatures m_enabledFeatures;
     VkSurfaceKHR m_surface;
     VkSwapchainKHR m_swapchain;
     std::vector<VkImage> m_swapchainImages;
     VkFormat m_swapchainImageFormat;
     VkExtent2D m_swapchainExtent;
+    VkPresentModeKHR m_presentMode;
     std::vector<VkImageView> m_swapchainImageViews;
+    std::vector<GpuAllocation> m_offscreenImageMemory;
+    VkFormat m_depthFormat;
+    VkImage m_depthImage;
+    GpuAllocation m_depthImageMemory;
+    VkImageView m_depthImageView;
     VkRenderPass m_renderPass;
     VkPipelineLayout m_pipelineLayout;
     VkPipeline m_graphicsPipeline;
     std::vector<VkFramebuffer> m_swapchainFramebuffers;
     VkCommandPool m_commandPool;
-    std::vector<VkCommandBuffer> m_commandBuffers;
-    std::vector<VkSemaphore> m_imageAvailableSemaphores;
-    std::vector<VkSemaphore> m_renderFinishedSemaphores;
-    std::vector<VkFence> m_inFlightFences;
+    VkPipelineCache m_pipelineCache;
+    std::string m_pipelineCacheFile;
+    PipelineBuilder m_pipelineBuilder;
+    UploadBatcher m_uploadBatcher;
+    uint32_t m_frameCount;
+    std::vector<FrameContext> m_frames;
     size_t m_currentFrame;
+    uint64_t m_frameNumber;
     bool m_framebufferResized;
 };